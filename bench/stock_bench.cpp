@@ -0,0 +1,615 @@
+// Microbenchmarks for the ingest, prediction and serialization paths.
+//
+// Generates a synthetic OHLCV history, times each benchmark for at least
+// --min-time seconds and prints one JSON document (ns/op, heap bytes and
+// allocations per op, throughput), so runs from different releases can be
+// compared with a plain diff or a script.
+//
+// Usage: stock_bench [--rows N] [--ingest-rows N] [--min-time SECONDS] [--filter TEXT] [--seed N] [--output FILE]
+
+#include "../include/DateTime.h"
+#include "../include/FileHandler.h"
+#include "../include/Indicators.h"
+#include "../include/ParameterSweep.h"
+#include "../include/PredictionAlgorithm.h"
+#include "../include/SeriesKernels.h"
+#include "../include/Snapshot.h"
+#include "../include/Stock.h"
+#include "../include/StockServer.h"
+#include "../include/WindowKernels.h"
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Every heap allocation in the process goes through these, so a benchmark's
+// allocation cost is the counter difference across its timed loop. The whole
+// set is replaced (plain, array, nothrow, sized and aligned) so no form falls
+// back to the library's allocator.
+namespace {
+    std::atomic<uint64_t> allocatedBytes{0};
+    std::atomic<uint64_t> allocationCount{0};
+
+    // Out of line so the compiler never pairs an inlined new with the free()
+    // in release() and reports a mismatched deallocation
+    __attribute__((noinline)) void* allocate(size_t size, size_t alignment) noexcept {
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        if (size == 0) size = 1;
+        if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+        // aligned_alloc wants a multiple of the alignment
+        return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+
+    __attribute__((noinline)) void release(void* ptr) noexcept {
+        std::free(ptr);
+    }
+
+    void* allocateOrThrow(size_t size, size_t alignment) {
+        if (void* ptr = allocate(size, alignment)) return ptr;
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(size_t size) { return allocateOrThrow(size, 0); }
+void* operator new[](size_t size) { return allocateOrThrow(size, 0); }
+void* operator new(size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept { release(ptr); }
+void operator delete[](void* ptr) noexcept { release(ptr); }
+void operator delete(void* ptr, size_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { release(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { release(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { release(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { release(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { release(ptr); }
+
+namespace {
+    const char* const SYMBOL = "BENCH";
+
+    struct Options {
+        size_t rows = 1000000;
+        // CSV ingest runs on its own, larger file
+        size_t ingestRows = 4000000;
+        double minTime = 0.5;
+        std::string filter;
+        uint64_t seed = 42;
+        std::string output;
+    };
+
+    struct Result {
+        std::string name;
+        uint64_t iterations = 0;
+        double nsPerOp = 0.0;
+        double bytesAllocatedPerOp = 0.0;
+        double allocationsPerOp = 0.0;
+        double itemsPerSecond = 0.0;
+        double bytesPerSecond = 0.0;
+    };
+
+    // Keeps the optimizer from discarding a benchmark's result
+    volatile size_t sink;
+
+    class Runner {
+    private:
+        const Options& options;
+        std::vector<Result> results;
+
+    public:
+        explicit Runner(const Options& opts) : options(opts) {}
+
+        // body() runs one operation and returns the bytes it processed (0 if
+        // not meaningful); items is the number of rows one operation handles
+        void run(const std::string& name, size_t items, const std::function<size_t()>& body) {
+            if (!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+
+            size_t bytesPerOp = body();  // warm-up: caches, lazy state, page faults
+
+            // Grow the batch until one batch takes at least minTime
+            uint64_t iterations = 1;
+            while (true) {
+                uint64_t bytesBefore = allocatedBytes.load(std::memory_order_relaxed);
+                uint64_t countBefore = allocationCount.load(std::memory_order_relaxed);
+                auto start = std::chrono::steady_clock::now();
+                for (uint64_t i = 0; i < iterations; ++i) {
+                    sink = body();
+                }
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                if (seconds >= options.minTime || iterations >= (uint64_t(1) << 40)) {
+                    Result result;
+                    result.name = name;
+                    result.iterations = iterations;
+                    result.nsPerOp = seconds * 1e9 / static_cast<double>(iterations);
+                    result.bytesAllocatedPerOp = static_cast<double>(
+                        allocatedBytes.load(std::memory_order_relaxed) - bytesBefore) / static_cast<double>(iterations);
+                    result.allocationsPerOp = static_cast<double>(
+                        allocationCount.load(std::memory_order_relaxed) - countBefore) / static_cast<double>(iterations);
+                    result.itemsPerSecond = static_cast<double>(items) * 1e9 / result.nsPerOp;
+                    result.bytesPerSecond = static_cast<double>(bytesPerOp) * 1e9 / result.nsPerOp;
+                    std::cerr << name << ": " << result.nsPerOp << " ns/op" << std::endl;
+                    results.push_back(result);
+                    return;
+                }
+                double scale = seconds > 0.0 ? options.minTime / seconds * 1.2 : 10.0;
+                iterations = std::max(iterations + 1, static_cast<uint64_t>(static_cast<double>(iterations) *
+                                                                            std::min(scale, 10.0)));
+            }
+        }
+
+        json toJson() const {
+            json list = json::array();
+            for (const auto& result : results) {
+                list.push_back({
+                    {"name", result.name},
+                    {"iterations", result.iterations},
+                    {"ns_per_op", result.nsPerOp},
+                    {"bytes_allocated_per_op", result.bytesAllocatedPerOp},
+                    {"allocations_per_op", result.allocationsPerOp},
+                    {"items_per_second", result.itemsPerSecond},
+                    {"bytes_per_second", result.bytesPerSecond}
+                });
+            }
+            return list;
+        }
+    };
+
+    // Random walk of minute bars, so any row count gets valid, increasing dates
+    void writeSyntheticCsv(const std::string& path, size_t rows, uint64_t seed) {
+        std::mt19937_64 random(seed);
+        std::normal_distribution<double> step(0.0, 0.5);
+        std::uniform_real_distribution<double> spread(0.0, 1.0);
+        std::uniform_int_distribution<int> volume(100000, 5000000);
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not create file: " + path);
+        }
+        out << "Date,Open,High,Low,Close,Volume\n";
+
+        const int64_t start = DateTime::daysFromCivil(2000, 1, 3) * DateTime::SECONDS_PER_DAY;
+        double close = 100.0;
+        char line[128];
+        for (size_t i = 0; i < rows; ++i) {
+            double open = close;
+            close = std::max(1.0, open + step(random));
+            double high = std::max(open, close) + spread(random);
+            double low = std::max(0.5, std::min(open, close) - spread(random));
+            int length = std::snprintf(line, sizeof(line), "%s,%.2f,%.2f,%.2f,%.2f,%d\n",
+                                       DateTime::format(start + static_cast<int64_t>(i) * 60, true).c_str(),
+                                       open, high, low, close, volume(random));
+            out.write(line, length);
+        }
+        if (!out) {
+            throw std::runtime_error("Could not write file: " + path);
+        }
+    }
+
+    // The original reader, kept as the reference for read_csv: getline per
+    // row, a stringstream split into strings, std::stod on every field
+    // twice (once to validate) and one StockData object per row
+    namespace LegacyCsv {
+        std::vector<std::string> splitLine(const std::string& line) {
+            std::vector<std::string> result;
+            std::stringstream ss(line);
+            std::string item;
+            while (std::getline(ss, item, ',')) {
+                result.push_back(item);
+            }
+            return result;
+        }
+
+        bool validEntry(const std::vector<std::string>& entry) {
+            if (entry.size() != 6) return false;
+            try {
+                for (size_t i = 1; i < entry.size(); ++i) {
+                    std::stod(entry[i]);
+                }
+                return true;
+            } catch (...) {
+                return false;
+            }
+        }
+
+        std::vector<StockData> read(const std::string& path, const std::string& symbol) {
+            std::vector<StockData> data;
+            std::ifstream file(path);
+            if (!file.is_open()) {
+                throw std::runtime_error("Could not open file: " + path);
+            }
+            std::string line;
+            std::getline(file, line);
+            while (std::getline(file, line)) {
+                auto parts = splitLine(line);
+                if (validEntry(parts)) {
+                    data.emplace_back(symbol, parts[0], std::stod(parts[1]), std::stod(parts[2]),
+                                      std::stod(parts[3]), std::stod(parts[4]), std::stod(parts[5]));
+                }
+            }
+            return data;
+        }
+    }
+
+    // Pulls a response body through its content provider, as the server
+    // would when writing to a socket; returns the body size
+    size_t drainResponse(httplib::Response& res) {
+        if (!res.content_provider_) return res.body.size();
+
+        size_t total = 0;
+        bool done = false;
+        httplib::DataSink sink;
+        sink.write = [&total](const char*, size_t length) {
+            total += length;
+            return true;
+        };
+        sink.done = [&done] { done = true; };
+        while (!done && res.content_provider_(total, 0, sink)) {
+        }
+        if (res.content_provider_resource_releaser_) res.content_provider_resource_releaser_(done);
+        return total;
+    }
+
+    std::string utcTimestamp() {
+        std::time_t now = std::time(nullptr);
+        return DateTime::format(static_cast<int64_t>(now), true);
+    }
+
+    Options parseOptions(int argc, char* argv[]) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto next = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--rows") options.rows = std::stoull(next());
+            else if (arg == "--ingest-rows") options.ingestRows = std::stoull(next());
+            else if (arg == "--min-time") options.minTime = std::stod(next());
+            else if (arg == "--filter") options.filter = next();
+            else if (arg == "--seed") options.seed = std::stoull(next());
+            else if (arg == "--output") options.output = next();
+            else throw std::invalid_argument("Unknown option: " + arg);
+        }
+        if (options.rows < 200) {
+            throw std::invalid_argument("--rows must be at least 200 (the largest SMA window)");
+        }
+        return options;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n"
+                  << "Usage: stock_bench [--rows N] [--ingest-rows N] [--min-time SECONDS] [--filter TEXT] [--seed N]"
+                     " [--output FILE]\n";
+        return 2;
+    }
+
+    namespace fs = std::filesystem;
+    fs::path workDir = fs::temp_directory_path() / ("stock_bench_" + std::to_string(std::random_device{}()));
+    fs::path csvDir = workDir / "csv";
+    fs::path ingestDir = workDir / "ingest";
+    fs::path snapshotDir = workDir / "snapshot";
+
+    try {
+        fs::create_directories(csvDir);
+        fs::create_directories(ingestDir);
+        fs::create_directories(snapshotDir);
+        std::string csvPath = (csvDir / (std::string(SYMBOL) + ".csv")).string();
+        writeSyntheticCsv(csvPath, options.rows, options.seed);
+        size_t csvBytes = fs::file_size(csvPath);
+
+        FileHandler csvFiles(csvDir.string());
+        auto series = std::make_shared<const PriceSeries>(csvFiles.readStockData(SYMBOL));
+        std::string snapshotPath = (snapshotDir / (std::string(SYMBOL) + Snapshot::FILE_EXTENSION)).string();
+        Snapshot::write(*series, snapshotPath);
+        size_t snapshotBytes = fs::file_size(snapshotPath);
+        FileHandler snapshotFiles(snapshotDir.string());
+
+        Runner runner(options);
+        const size_t rows = series->size();
+
+        // Ingest: the mmap/from_chars parser against the original reader, on
+        // a file of --ingest-rows rows
+        size_t ingestBytes = 0;
+        // Skip writing the large file when --filter leaves nothing to run on it
+        if (options.filter.empty() || std::string("read_csv/legacy").find(options.filter) != std::string::npos) {
+            std::string ingestPath = (ingestDir / (std::string(SYMBOL) + ".csv")).string();
+            writeSyntheticCsv(ingestPath, options.ingestRows, options.seed);
+            ingestBytes = fs::file_size(ingestPath);
+            FileHandler ingestFiles(ingestDir.string());
+            runner.run("read_csv", options.ingestRows, [&] {
+                auto data = ingestFiles.readStockData(SYMBOL);
+                return data.size() == options.ingestRows ? ingestBytes : 0;
+            });
+            runner.run("read_csv/legacy", options.ingestRows, [&] {
+                auto data = LegacyCsv::read(ingestPath, SYMBOL);
+                return data.size() == options.ingestRows ? ingestBytes : 0;
+            });
+            fs::remove(ingestPath);
+        }
+        runner.run("read_snapshot", rows, [&] {
+            auto data = snapshotFiles.readStockData(SYMBOL);
+            return data.size() == rows ? snapshotBytes : 0;
+        });
+
+        // Algorithms, on the in-memory series
+        for (int window : {5, 20, 50, 200}) {
+            MovingAverageAlgorithm sma(window);
+            runner.run("sma_predict/window=" + std::to_string(window), rows, [&] {
+                return sma.predict(*series).size() * sizeof(double);
+            });
+        }
+        // Window-mean kernels alone, into a reused buffer: the rolling sum
+        // any window can use next to the compile-time specialisations
+        // behind sma_predict, plus one specialisation instantiated for floats
+        // (built for the baseline instruction set, as this file is)
+        auto closeColumn = series->getCloses();
+        std::vector<double> means(rows);
+        for (size_t window : {5, 20, 50, 200}) {
+            auto fixedMean = SeriesKernels::fixedWindowMean(window);
+            runner.run("window_mean/rolling/window=" + std::to_string(window), rows, [&] {
+                SeriesKernels::rollingMean(closeColumn.data(), rows, window, means.data());
+                return rows * sizeof(double);
+            });
+            runner.run("window_mean/fixed/window=" + std::to_string(window), rows, [&] {
+                fixedMean(closeColumn.data(), rows, means.data());
+                return rows * sizeof(double);
+            });
+        }
+        std::vector<float> closesFloat(closeColumn.begin(), closeColumn.end());
+        std::vector<float> meansFloat(rows);
+        runner.run("window_mean/fixed_float/window=20", rows, [&] {
+            WindowKernels::slidingMean<WindowKernels::Window20<float>>(closesFloat.data(), rows, meansFloat.data());
+            return rows * sizeof(float);
+        });
+
+        ExponentialMovingAverageAlgorithm ema(0.2);
+        runner.run("ema_predict", rows, [&] {
+            return ema.predict(*series).size() * sizeof(double);
+        });
+
+        // Technical indicators: ten in one fused pass, the same ten one
+        // predict() at a time, and a single one for scale
+        std::vector<std::unique_ptr<Indicator>> indicators;
+        indicators.push_back(std::make_unique<WeightedMovingAverageAlgorithm>(10));
+        indicators.push_back(std::make_unique<WeightedMovingAverageAlgorithm>(50));
+        indicators.push_back(std::make_unique<BollingerBandsAlgorithm>(20, 2.0, "upper"));
+        indicators.push_back(std::make_unique<BollingerBandsAlgorithm>(20, 2.0, "lower"));
+        indicators.push_back(std::make_unique<RelativeStrengthIndexAlgorithm>(14));
+        indicators.push_back(std::make_unique<RelativeStrengthIndexAlgorithm>(28));
+        indicators.push_back(std::make_unique<MacdAlgorithm>(12, 26, 9, "macd"));
+        indicators.push_back(std::make_unique<MacdAlgorithm>(12, 26, 9, "histogram"));
+        indicators.push_back(std::make_unique<AverageTrueRangeAlgorithm>(14));
+        indicators.push_back(std::make_unique<AverageTrueRangeAlgorithm>(28));
+        std::vector<const Indicator*> fused;
+        for (const auto& indicator : indicators) fused.push_back(indicator.get());
+        std::vector<std::vector<double>> indicatorOutputs(fused.size());
+        std::vector<std::vector<double>*> indicatorTargets;
+        for (auto& output : indicatorOutputs) indicatorTargets.push_back(&output);
+
+        runner.run("indicators/rsi", rows, [&] {
+            return indicators[4]->predict(*series).size() * sizeof(double);
+        });
+        runner.run("indicators/fused=10", rows, [&] {
+            IndicatorEngine::run(*series, fused, indicatorTargets);
+            return rows * 5 * sizeof(double);
+        });
+        runner.run("indicators/separate=10", rows, [&] {
+            for (size_t i = 0; i < fused.size(); ++i) {
+                fused[i]->predictInto(*series, indicatorOutputs[i]);
+            }
+            return rows * 5 * sizeof(double) * fused.size();
+        });
+
+        // Parameter sweeps over the most recent bars, against the same
+        // settings run one predict() at a time
+        const size_t sweepColumns = std::min<size_t>(rows - 199, 10000);
+        const size_t sweepBegin = rows - sweepColumns;
+        std::vector<int> windows;
+        for (int window = 2; window <= 200; ++window) windows.push_back(window);
+        std::vector<double> alphas;
+        for (int i = 1; i <= 64; ++i) alphas.push_back(i / 65.0);
+        auto smaHistory = PriceSeries::slice(series, sweepBegin - 199, rows);
+        size_t emaWarmup = std::min(sweepBegin, ExponentialMovingAverageAlgorithm(alphas.front()).getWarmup());
+        auto emaHistory = PriceSeries::slice(series, sweepBegin - emaWarmup, rows);
+
+        runner.run("sweep/sma_windows=2..200", windows.size() * sweepColumns, [&] {
+            return ParameterSweep::run(series, windows, {}, sweepBegin, rows).sma.size() * sizeof(double);
+        });
+        runner.run("sweep/sma_predict_each", windows.size() * sweepColumns, [&] {
+            size_t bytes = 0;
+            std::vector<double> out;
+            for (int window : windows) {
+                MovingAverageAlgorithm(window).predictInto(smaHistory, out);
+                bytes += out.size() * sizeof(double);
+            }
+            return bytes;
+        });
+        runner.run("sweep/ema_alphas=64", alphas.size() * sweepColumns, [&] {
+            return ParameterSweep::run(series, {}, alphas, sweepBegin, rows).ema.size() * sizeof(double);
+        });
+        runner.run("sweep/ema_predict_each", alphas.size() * sweepColumns, [&] {
+            size_t bytes = 0;
+            std::vector<double> out;
+            for (double alpha : alphas) {
+                ExponentialMovingAverageAlgorithm(alpha).predictInto(emaHistory, out);
+                bytes += out.size() * sizeof(double);
+            }
+            return bytes;
+        });
+
+        // The pre-streaming /api/stocks serializer: one nlohmann object per
+        // row, dumped at the end. Kept as the baseline for handler/get_stock.
+        runner.run("stocks_json/nlohmann", rows, [&] {
+            auto opens = series->getOpens();
+            auto highs = series->getHighs();
+            auto lows = series->getLows();
+            auto closes = series->getCloses();
+            auto volumes = series->getVolumes();
+            json response = json::array();
+            for (size_t i = 0; i < series->size(); ++i) {
+                response.push_back({
+                    {"symbol", series->getSymbol()},
+                    {"date", series->getDate(i)},
+                    {"open", opens[i]},
+                    {"high", highs[i]},
+                    {"low", lows[i]},
+                    {"close", closes[i]},
+                    {"volume", volumes[i]}
+                });
+            }
+            return response.dump().size();
+        });
+
+        // End to end through the route handlers, in-process (no socket). The
+        // data is cached after the warm-up call, as on a warm server.
+        StockServer server(csvDir.string(), StockPredictor::DEFAULT_CACHE_BUDGET, 0, 0);
+
+        httplib::Request getStock;
+        getStock.method = "GET";
+        getStock.path = std::string("/api/stocks/") + SYMBOL;
+        std::regex_match(getStock.path, getStock.matches, std::regex(R"(/api/stocks/([^/]+))"));
+        runner.run("handler/get_stock", rows, [&] {
+            httplib::Response res;
+            server.handleGetStock(getStock, res);
+            return drainResponse(res);
+        });
+
+        httplib::Request getPage = getStock;
+        std::regex_match(getPage.path, getPage.matches, std::regex(R"(/api/stocks/([^/]+))"));
+        getPage.params.emplace("from", DateTime::format(series->getTimestamps()[rows / 2], true));
+        getPage.params.emplace("limit", "100");
+        runner.run("handler/get_stock_page", 100, [&] {
+            httplib::Response res;
+            server.handleGetStock(getPage, res);
+            return drainResponse(res);
+        });
+
+        for (const char* algorithm : {"SMA", "EMA"}) {
+            httplib::Request predict;
+            predict.method = "POST";
+            predict.path = "/api/predict";
+            predict.body = json({{"symbol", SYMBOL}, {"algorithm", algorithm}, {"persist", false}}).dump();
+            runner.run(std::string("handler/predict/") + algorithm, rows, [&] {
+                httplib::Response res;
+                server.handlePredict(predict, res);
+                return drainResponse(res);
+            });
+        }
+
+        httplib::Request sweep;
+        sweep.method = "POST";
+        sweep.path = "/api/sweep";
+        sweep.body = json({
+            {"symbol", SYMBOL},
+            {"sma", json::object()},
+            {"ema", {{"min", 0.05}, {"max", 0.95}, {"step", 0.05}}},
+            {"from", DateTime::format(series->getTimestamps()[sweepBegin], true)}
+        }).dump();
+        runner.run("handler/sweep", (windows.size() + 19) * sweepColumns, [&] {
+            httplib::Response res;
+            server.handleSweep(sweep, res);
+            return drainResponse(res);
+        });
+
+        // An upload analyzed by one algorithm and by all of them; parsing
+        // the upload dominates both
+        std::string upload;
+        {
+            std::ifstream in(csvPath, std::ios::binary);
+            upload.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        for (const char* algorithm : {"SMA", ""}) {
+            httplib::Request analyze;
+            analyze.method = "POST";
+            analyze.path = "/api/analyze";
+            analyze.files.emplace("csv_file", httplib::MultipartFormData{"csv_file", upload, "upload.csv", "text/csv"});
+            if (*algorithm) analyze.params.emplace("algorithm", algorithm);
+            analyze.params.emplace("limit", "100");
+            runner.run(std::string("handler/analyze/") + (*algorithm ? algorithm : "all"), rows, [&] {
+                httplib::Response res;
+                server.handleAnalyze(analyze, res);
+                return drainResponse(res);
+            });
+        }
+
+        json report = {
+            {"context", {
+                {"date", utcTimestamp()},
+                {"rows", rows},
+                {"csv_bytes", csvBytes},
+                {"ingest_rows", options.ingestRows},
+                {"ingest_csv_bytes", ingestBytes},
+                {"snapshot_bytes", snapshotBytes},
+                {"min_time_s", options.minTime},
+                {"seed", options.seed},
+                {"hardware_threads", std::thread::hardware_concurrency()},
+                {"instruction_set", SeriesKernels::activeInstructionSet()},
+#ifdef __VERSION__
+                {"compiler", __VERSION__},
+#endif
+#ifdef __OPTIMIZE__
+                {"optimized", true}
+#else
+                {"optimized", false}
+#endif
+            }},
+            {"benchmarks", runner.toJson()}
+        };
+
+        if (options.output.empty()) {
+            std::cout << report.dump(2) << std::endl;
+        } else {
+            std::ofstream out(options.output);
+            out << report.dump(2) << "\n";
+            if (!out) throw std::runtime_error("Could not write file: " + options.output);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::error_code ec;
+        fs::remove_all(workDir, ec);
+        return 1;
+    }
+
+    std::error_code ec;
+    fs::remove_all(workDir, ec);
+    return 0;
+}
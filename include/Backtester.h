@@ -0,0 +1,48 @@
+#pragma once
+#include "PredictionAlgorithm.h"
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Forecast accuracy of one algorithm on one series. Each scored step is a
+// bar t whose prediction is taken as the forecast of the close horizon bars
+// later.
+struct BacktestMetrics {
+    size_t steps = 0;             // forecasts scored
+    double mae = 0.0;             // mean absolute error
+    double rmse = 0.0;            // root mean squared error
+    double mape = 0.0;            // mean absolute percentage error, in percent
+    double hitRate = 0.0;         // share of non-flat moves whose direction was called
+    size_t directionalSteps = 0;  // steps where the close moved
+};
+
+// Bars scored by a backtest: forecasts made at bars dated in [from, to)
+// whose target bar is also before to
+struct BacktestWindow {
+    int64_t from = std::numeric_limits<int64_t>::min();
+    int64_t to = std::numeric_limits<int64_t>::max();
+    size_t horizon = 1;
+};
+
+// Walk-forward scoring of prediction algorithms. Algorithms are causal by
+// contract (prediction i only sees bars up to i + getLookback()), so one
+// pass over the series gives the same forecasts as re-running the algorithm
+// at every step, at the cost of a single predict.
+class Backtester {
+public:
+    static constexpr size_t MAX_HORIZON = 1000;
+
+    // Scores algo over window. scratch holds the predictions and is reused
+    // across calls, so a worker that keeps its own buffer allocates nothing
+    // once it has seen its longest series. Returns zero steps when the
+    // window holds too few bars.
+    static BacktestMetrics evaluate(const PredictionAlgorithm& algo, const std::shared_ptr<const PriceSeries>& series,
+                                    const BacktestWindow& window, std::vector<double>& scratch);
+
+    // Value of "mae", "rmse", "mape" or "hit_rate"; throws for other names
+    static double metric(const BacktestMetrics& metrics, const std::string& name);
+    // True when a lower value of the metric is better
+    static bool lowerIsBetter(const std::string& name);
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+// Appends CBOR (RFC 8949) or MessagePack straight into a byte buffer: the
+// binary counterpart of JsonWriter, producing the same documents. Arrays and
+// objects carry their length up front, so there is nothing to close and no
+// nesting state; a document can be cleared and continued chunk by chunk.
+//
+// Doubles are always written as 8-byte floats. NaN and infinities are
+// written as null, as in the JSON responses.
+class BinaryWriter {
+public:
+    enum class Format { Cbor, MsgPack };
+
+private:
+    Format format;
+    std::pmr::string buffer;
+
+    void appendBigEndian(uint64_t value, size_t bytes);
+    // CBOR major type with its argument in the shortest form
+    void cborHead(uint8_t major, uint64_t argument);
+    // MessagePack string/array/map header: the fix form below fixLimit,
+    // otherwise the first marker whose length field fits
+    void msgpackHead(uint8_t fixBase, uint64_t fixLimit, const uint8_t (&markers)[3], uint64_t length);
+
+public:
+    explicit BinaryWriter(Format format, size_t reserveBytes = 0,
+                          std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    BinaryWriter& beginArray(size_t count);
+    // pairs key/value pairs follow
+    BinaryWriter& beginObject(size_t pairs);
+    // Nothing to close; these let one template write through either writer
+    BinaryWriter& endArray() { return *this; }
+    BinaryWriter& endObject() { return *this; }
+    BinaryWriter& key(std::string_view name) { return value(name); }
+
+    BinaryWriter& value(double number);
+    BinaryWriter& value(int number) { return value(static_cast<int64_t>(number)); }
+    BinaryWriter& value(int64_t number);
+    BinaryWriter& value(uint64_t number);
+    BinaryWriter& value(bool flag);
+    BinaryWriter& value(std::string_view text);
+    BinaryWriter& value(const char* text) { return value(std::string_view(text)); }
+    BinaryWriter& null();
+
+    std::string_view str() const { return buffer; }
+    size_t size() const { return buffer.size(); }
+    // Drops the buffered bytes but keeps the capacity
+    void clear() { buffer.clear(); }
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+// Header of one frame of the raw column response format
+// (application/vnd.stock.columns).
+//
+// All integers and floats are little-endian. The header is followed by the
+// metadata, a UTF-8 JSON object of metadataSize bytes zero-padded to a
+// multiple of 8, and then the columns back to back:
+//   timestamps (epoch seconds)   int64[rowCount]
+//   metadata "columns" in order  float64 or float32[rowCount] each
+// A response is one or more frames; batch responses send one per result.
+// Each frame starts at a multiple of 8 bytes from the start of the body,
+// after zero padding where the previous frame ended short of that.
+struct ColumnFrameHeader {
+    char magic[4];          // "SCOL"
+    uint8_t version;
+    uint8_t valueBytes;     // 8 = float64, 4 = float32
+    uint16_t columnCount;
+    uint32_t metadataSize;
+    uint32_t reserved;      // zero
+    uint64_t rowCount;
+};
+static_assert(sizeof(ColumnFrameHeader) == 24, "column frame header layout changed");
+
+class ColumnFrame {
+public:
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    // Timestamp of a row with no bar (a prediction past the end of the series)
+    static constexpr int64_t NO_TIMESTAMP = std::numeric_limits<int64_t>::min();
+
+    // Alignment padding, header and padded metadata; out must hold only
+    // whole frames. valueBytes is 4 or 8. Throws on big-endian hosts, where
+    // the columns could not be copied as they are.
+    static void appendHeader(std::pmr::string& out, uint8_t valueBytes, size_t columnCount, size_t rowCount,
+                             std::string_view metadata);
+    static void appendTimestamps(std::pmr::string& out, const int64_t* timestamps, size_t count);
+    // float64 values are copied as they are; float32 ones are rounded
+    static void appendValues(std::pmr::string& out, uint8_t valueBytes, const double* values, size_t count);
+};
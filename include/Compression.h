@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+struct z_stream_s;
+
+// HTTP content codings the server can apply to response bodies
+enum class ContentCoding { Identity, Gzip, Deflate };
+
+class Compression {
+public:
+    static constexpr int DEFAULT_LEVEL = 6;
+
+    // Coding to use for an Accept-Encoding header: the supported coding with
+    // the highest q, gzip on a tie. * counts as gzip; a missing header or
+    // one naming nothing supported gets Identity.
+    static ContentCoding negotiate(std::string_view acceptEncoding);
+    // Content-Encoding token ("gzip", "deflate"); empty for Identity
+    static const char* name(ContentCoding coding);
+    // The whole body in one gzip or zlib stream
+    static std::string compress(std::string_view body, ContentCoding coding, int level = DEFAULT_LEVEL);
+};
+
+// Incremental gzip/deflate for chunked responses. Every write ends on a sync
+// flush, so the client can decode each chunk as soon as it arrives instead
+// of waiting for the compressor's window to fill.
+class StreamCompressor {
+private:
+    std::unique_ptr<z_stream_s> stream;
+
+    void deflateInto(std::string_view input, int flush, std::string& out);
+
+public:
+    // coding must be Gzip or Deflate
+    explicit StreamCompressor(ContentCoding coding, int level = Compression::DEFAULT_LEVEL);
+    ~StreamCompressor();
+
+    StreamCompressor(const StreamCompressor&) = delete;
+    StreamCompressor& operator=(const StreamCompressor&) = delete;
+
+    // Compresses input and appends the flushed output to out
+    void write(std::string_view input, std::string& out);
+    // Appends the end of the stream; nothing may be written afterwards
+    void finish(std::string& out);
+};
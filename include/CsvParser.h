@@ -0,0 +1,35 @@
+#pragma once
+#include "PriceSeries.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A rejected data row, reported with its 1-based line number in the source
+struct CsvParseError {
+    size_t line;
+    std::string message;
+};
+
+// Single-pass parser for "Date,Open,High,Low,Close,Volume" content.
+// Fields are sliced in place and converted with std::from_chars, so each
+// value is validated and converted exactly once. Dates are parsed with
+// DateTime::parse and must be strictly increasing.
+class StockCsvParser {
+public:
+    static constexpr size_t FIELD_COUNT = 6;
+
+    // Parses everything after the header line. Malformed rows, and rows
+    // not dated after the previous accepted row, are skipped and, when
+    // errors is given, recorded there.
+    static PriceSeries parse(std::string_view content, const std::string& symbol,
+                             std::vector<CsvParseError>* errors = nullptr);
+
+    // Parses one data row into its date (text and epoch seconds) and the
+    // five numeric columns. Returns false and sets error when the row is
+    // malformed.
+    static bool parseRow(std::string_view line, std::string_view& date, int64_t& timestamp,
+                         double (&values)[FIELD_COUNT - 1], std::string& error);
+
+    static bool parseNumber(std::string_view field, double& value);
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Conversions between the date strings found in price files and UTC epoch
+// seconds. Accepted forms are "YYYY-MM-DD", optionally followed by a space
+// or 'T' and "HH:MM" or "HH:MM:SS", optionally ending in 'Z'.
+class DateTime {
+public:
+    static constexpr int64_t SECONDS_PER_DAY = 86400;
+
+    // Returns false unless the whole field is a valid date or timestamp
+    static bool parse(std::string_view text, int64_t& epochSeconds);
+
+    // Parses a period for range queries: "YYYY", "YYYY-MM" or anything
+    // parse() accepts. [start, end) covers the whole period, so "2024-03"
+    // is all of March and "2024-03-05" is all of that day.
+    static bool parsePeriod(std::string_view text, int64_t& start, int64_t& end);
+
+    // "YYYY-MM-DD", or "YYYY-MM-DD HH:MM:SS" with includeTime; the inverse
+    // of parse()
+    static std::string format(int64_t epochSeconds, bool includeTime = false);
+
+    // Days since 1970-01-01 of a proleptic Gregorian date
+    static int64_t daysFromCivil(int64_t year, unsigned month, unsigned day);
+};
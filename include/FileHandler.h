@@ -1,8 +1,21 @@
 #pragma once
-#include "Stock.h"
+#include "PriceSeries.h"
+#include "CsvParser.h"
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstdint>
+
+// Identifies one revision of a data file; any write changes mtime or size
+struct FileVersion {
+    int64_t modifiedTime = 0;
+    uintmax_t size = 0;
+
+    bool operator==(const FileVersion& other) const {
+        return modifiedTime == other.modifiedTime && size == other.size;
+    }
+    bool operator!=(const FileVersion& other) const { return !(*this == other); }
+};
 
 class FileHandler {
 private:
@@ -12,8 +25,23 @@ public:
     explicit FileHandler(const std::string& directory);
 
     // File operations
-    std::vector<StockData> readStockData(const std::string& symbol);
-    void writePredictions(const std::string& symbol, const std::vector<double>& predictions);
+    // Reads SYMBOL.bin when it exists and is at least as new as SYMBOL.csv,
+    // otherwise parses the CSV. Malformed CSV rows are skipped; pass errors
+    // to collect them with line numbers.
+    PriceSeries readStockData(const std::string& symbol,
+                              std::vector<CsvParseError>* errors = nullptr);
+    // Version of whichever file readStockData would read
+    FileVersion getFileVersion(const std::string& symbol);
+    // Symbols with a CSV file or snapshot in the data directory, sorted
+    std::vector<std::string> listSymbols();
+    // Appends rows to SYMBOL.csv. A symbol read from its snapshot gets a new
+    // SYMBOL.csv holding the snapshot's bars and the new ones, so its history
+    // is kept.
+    void appendStockData(const std::string& symbol, const PriceSeries& bars);
+    // Replaces SYMBOL_predictions.csv atomically. Prediction i is dated with
+    // bar lookback + i of data.
+    void writePredictions(const std::string& symbol, const PriceSeries& data, size_t lookback,
+                          const std::vector<double>& predictions);
 
     // Validation
     bool validateCSVFormat(const std::string& filePath);
@@ -23,6 +51,13 @@ public:
     std::string getDataDirectory() const { return dataDirectory; }
 
 private:
-    std::vector<std::string> splitCSVLine(const std::string& line);
+    struct DataFile {
+        std::string path;
+        bool isSnapshot;
+        FileVersion version;
+    };
+
+    DataFile resolveDataFile(const std::string& symbol);
+    std::string buildSnapshotPath(const std::string& symbol);
     std::string buildFilePath(const std::string& symbol, bool isPrediction = false);
 };
\ No newline at end of file
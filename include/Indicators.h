@@ -0,0 +1,183 @@
+#pragma once
+#include "PredictionAlgorithm.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// One block of bars handed to every indicator in a fused pass. The columns
+// cover the whole series, so windows can reach back before begin; the
+// derived columns cover [begin, end) only and are indexed t - begin.
+struct IndicatorBlock {
+    const double* closes = nullptr;
+    const double* highs = nullptr;
+    const double* lows = nullptr;
+    size_t begin = 0;
+    size_t end = 0;
+
+    // Filled only when some indicator in the pass asks for them
+    const double* gains = nullptr;       // rise of the close from the previous bar (0 at bar 0)
+    const double* losses = nullptr;      // fall of the close from the previous bar (0 at bar 0)
+    const double* trueRanges = nullptr;  // high - low at bar 0
+};
+
+// Running state of one indicator during a pass. Blocks arrive in order and
+// each writes the predictions for its bars: out[t - lookback] for bar t.
+class IndicatorKernel {
+public:
+    virtual ~IndicatorKernel() = default;
+    virtual void process(const IndicatorBlock& block, double* out) = 0;
+};
+
+// Indicators are computed by IndicatorEngine, which streams the series once
+// for any number of them; predict() is a pass with just this one.
+class Indicator : public PredictionAlgorithm {
+public:
+    // Derived columns an indicator can ask for
+    enum Input : unsigned {
+        PRICE_CHANGES = 1,
+        TRUE_RANGES = 2
+    };
+
+    std::vector<double> predict(const PriceSeries& data) const override;
+    void predictInto(const PriceSeries& data, std::vector<double>& out) const override;
+
+    // Input flags the kernel reads from its blocks
+    virtual unsigned getInputs() const { return 0; }
+    virtual std::unique_ptr<IndicatorKernel> createKernel() const = 0;
+
+    // Throws std::runtime_error when data has too few bars for one prediction
+    void checkLength(const PriceSeries& data) const;
+};
+
+// Computes many indicators in a single pass over a columnar series. Bars
+// are processed in blocks small enough to stay in cache: each block's
+// columns are read from memory once, the derived columns (price changes,
+// true ranges) are computed once with vector kernels, and then every
+// indicator consumes the block. Ten indicators cost about the memory
+// traffic of one, plus their own outputs.
+class IndicatorEngine {
+public:
+    static constexpr size_t BLOCK_BARS = 2048;
+
+    // outputs[i] receives the predictions of indicators[i] and is resized.
+    // Throws std::runtime_error, before any work, if the series is too
+    // short for one of them.
+    static void run(const PriceSeries& data, const std::vector<const Indicator*>& indicators,
+                    const std::vector<std::vector<double>*>& outputs);
+};
+
+// Weighted Moving Average: the newest of window_size closes weighs
+// window_size, the oldest 1
+class WeightedMovingAverageAlgorithm : public Indicator {
+private:
+    int windowSize;
+    static constexpr int MIN_WINDOW = 2;
+    static constexpr int MAX_WINDOW = 200;
+
+public:
+    explicit WeightedMovingAverageAlgorithm(int window = 10);
+    std::string getName() const override { return "WMA"; }
+    std::string getDescription() const override;
+    std::unique_ptr<PredictionAlgorithm> clone() const override;
+    std::unique_ptr<IndicatorKernel> createKernel() const override;
+    size_t getLookback() const override { return static_cast<size_t>(windowSize) - 1; }
+
+    void configure(const nlohmann::json& params) override;
+    nlohmann::json getParameters() const override;
+    void validate() const override;
+};
+
+// Bollinger Bands: window_size-bar mean plus num_std population standard
+// deviations; band picks the "upper", "middle" or "lower" line
+class BollingerBandsAlgorithm : public Indicator {
+private:
+    int windowSize;
+    double numStd;
+    std::string band;
+    static constexpr int MIN_WINDOW = 2;
+    static constexpr int MAX_WINDOW = 200;
+    static constexpr double MIN_STD = 0.1;
+    static constexpr double MAX_STD = 10.0;
+
+public:
+    explicit BollingerBandsAlgorithm(int window = 20, double deviations = 2.0, const std::string& line = "middle");
+    std::string getName() const override { return "BOLLINGER"; }
+    std::string getDescription() const override;
+    std::unique_ptr<PredictionAlgorithm> clone() const override;
+    std::unique_ptr<IndicatorKernel> createKernel() const override;
+    size_t getLookback() const override { return static_cast<size_t>(windowSize) - 1; }
+
+    void configure(const nlohmann::json& params) override;
+    nlohmann::json getParameters() const override;
+    void validate() const override;
+};
+
+// Relative Strength Index (0-100) with Wilder smoothing over period bars
+class RelativeStrengthIndexAlgorithm : public Indicator {
+private:
+    int period;
+    static constexpr int MIN_PERIOD = 2;
+    static constexpr int MAX_PERIOD = 200;
+
+public:
+    explicit RelativeStrengthIndexAlgorithm(int periods = 14);
+    std::string getName() const override { return "RSI"; }
+    std::string getDescription() const override;
+    std::unique_ptr<PredictionAlgorithm> clone() const override;
+    std::unique_ptr<IndicatorKernel> createKernel() const override;
+    unsigned getInputs() const override { return PRICE_CHANGES; }
+    size_t getLookback() const override { return static_cast<size_t>(period); }
+    size_t getWarmup() const override;
+
+    void configure(const nlohmann::json& params) override;
+    nlohmann::json getParameters() const override;
+    void validate() const override;
+};
+
+// MACD: fast minus slow EMA of the closes, its signal-period EMA, or their
+// difference, chosen by output ("macd", "signal" or "histogram"). The EMAs
+// are seeded with the first bar, like the EMA algorithm.
+class MacdAlgorithm : public Indicator {
+private:
+    int fastPeriod;
+    int slowPeriod;
+    int signalPeriod;
+    std::string output;
+    static constexpr int MIN_PERIOD = 2;
+    static constexpr int MAX_PERIOD = 200;
+
+public:
+    explicit MacdAlgorithm(int fast = 12, int slow = 26, int signal = 9, const std::string& line = "macd");
+    std::string getName() const override { return "MACD"; }
+    std::string getDescription() const override;
+    std::unique_ptr<PredictionAlgorithm> clone() const override;
+    std::unique_ptr<IndicatorKernel> createKernel() const override;
+    size_t getWarmup() const override;
+
+    void configure(const nlohmann::json& params) override;
+    nlohmann::json getParameters() const override;
+    void validate() const override;
+};
+
+// Average True Range with Wilder smoothing over period bars; reads the
+// high and low columns as well as the closes
+class AverageTrueRangeAlgorithm : public Indicator {
+private:
+    int period;
+    static constexpr int MIN_PERIOD = 2;
+    static constexpr int MAX_PERIOD = 200;
+
+public:
+    explicit AverageTrueRangeAlgorithm(int periods = 14);
+    std::string getName() const override { return "ATR"; }
+    std::string getDescription() const override;
+    std::unique_ptr<PredictionAlgorithm> clone() const override;
+    std::unique_ptr<IndicatorKernel> createKernel() const override;
+    unsigned getInputs() const override { return TRUE_RANGES; }
+    size_t getLookback() const override { return static_cast<size_t>(period) - 1; }
+    size_t getWarmup() const override;
+
+    void configure(const nlohmann::json& params) override;
+    nlohmann::json getParameters() const override;
+    void validate() const override;
+};
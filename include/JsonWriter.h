@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Appends JSON text straight into a string buffer, with no intermediate
+// document. Numbers are formatted with std::to_chars (shortest round-trip
+// form); NaN and infinities are written as null, as nlohmann::json does.
+//
+// Callers that stream take the buffer once it is large enough, send it and
+// clear() it; commas and nesting carry over, so one document can be spread
+// over any number of chunks. The buffer comes from the given memory
+// resource, typically the request's arena (see RequestArena).
+class JsonWriter {
+private:
+    std::pmr::string buffer;
+    // One entry per open array/object: true once it holds a value
+    std::pmr::vector<bool> hasValue;
+    bool afterKey = false;
+
+    void separate();
+
+public:
+    explicit JsonWriter(size_t reserveBytes = 0,
+                        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+    // Sized forms matching BinaryWriter; JSON does not need the count
+    JsonWriter& beginObject(size_t) { return beginObject(); }
+    JsonWriter& beginArray(size_t) { return beginArray(); }
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& value(double number);
+    JsonWriter& value(int number) { return value(static_cast<int64_t>(number)); }
+    JsonWriter& value(int64_t number);
+    JsonWriter& value(uint64_t number);
+    JsonWriter& value(bool flag);
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const char* text) { return value(std::string_view(text)); }
+    JsonWriter& null();
+
+    // Inserts text that is already valid JSON as the next value
+    JsonWriter& raw(std::string_view json);
+
+    std::string_view str() const { return buffer; }
+    size_t size() const { return buffer.size(); }
+    // Drops the buffered text but keeps the nesting state and capacity
+    void clear() { buffer.clear(); }
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <sstream>
+#include <string>
+#include <string_view>
+
+// Compile-time floor for logging: 0 error, 1 warn, 2 info, 3 debug.
+// Statements above it are discarded by the compiler, so debug logging on
+// hot paths costs nothing in normal builds (see STOCK_LOG_LEVEL in CMake).
+#ifndef STOCK_LOG_LEVEL
+#define STOCK_LOG_LEVEL 2
+#endif
+
+enum class LogLevel { Error = 0, Warn = 1, Info = 2, Debug = 3 };
+
+// Leveled logging to stderr, one line per message. Levels compiled in can
+// still be filtered at run time (the LOG_LEVEL environment variable).
+class Log {
+public:
+    static bool enabled(LogLevel level);
+    static void setLevel(LogLevel level);
+    static LogLevel getLevel();
+
+    // Accepts "error", "warn", "info" or "debug"
+    static bool parseLevel(std::string_view text, LogLevel& level);
+
+    static void write(LogLevel level, const std::string& message);
+};
+
+// The message is a stream expression, e.g. LOG_DEBUG("read " << n << " rows"),
+// and is only evaluated when the level is enabled
+#define STOCK_LOG(level, message)                                                     \
+    do {                                                                              \
+        if constexpr (static_cast<int>(level) <= STOCK_LOG_LEVEL) {                   \
+            if (Log::enabled(level)) {                                                \
+                std::ostringstream stockLogStream;                                    \
+                stockLogStream << message;                                            \
+                Log::write(level, stockLogStream.str());                              \
+            }                                                                         \
+        }                                                                             \
+    } while (0)
+
+#define LOG_ERROR(message) STOCK_LOG(LogLevel::Error, message)
+#define LOG_WARN(message) STOCK_LOG(LogLevel::Warn, message)
+#define LOG_INFO(message) STOCK_LOG(LogLevel::Info, message)
+#define LOG_DEBUG(message) STOCK_LOG(LogLevel::Debug, message)
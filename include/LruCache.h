@@ -0,0 +1,133 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t usedBytes = 0;
+    size_t capacityBytes = 0;
+};
+
+// Thread-safe least-recently-used cache bounded by a total cost budget.
+// Each entry is inserted with a cost (usually its size in bytes); the least
+// recently used entries are evicted until the budget is respected again.
+template <typename Key, typename Value>
+class LruCache {
+private:
+    struct Entry {
+        Key key;
+        Value value;
+        size_t cost;
+    };
+
+    std::list<Entry> order;  // front = most recently used
+    std::unordered_map<Key, typename std::list<Entry>::iterator> index;
+    mutable std::mutex mutex;
+    size_t capacity;
+    size_t used = 0;
+
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+
+    void evictLocked() {
+        while (used > capacity && !order.empty()) {
+            used -= order.back().cost;
+            index.erase(order.back().key);
+            order.pop_back();
+            evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    explicit LruCache(size_t capacityBytes) : capacity(capacityBytes) {}
+
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+
+    std::optional<Value> get(const Key& key) {
+        return get(key, [](const Value&) { return true; });
+    }
+
+    // Looks up key and returns its value if isFresh(value) holds. Stale
+    // entries are dropped and reported as misses.
+    template <typename Predicate>
+    std::optional<Value> get(const Key& key, Predicate&& isFresh) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        if (!isFresh(it->second->value)) {
+            used -= it->second->cost;
+            order.erase(it->second);
+            index.erase(it);
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        order.splice(order.begin(), order, it->second);
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return it->second->value;
+    }
+
+    // Inserts or replaces key. Values costlier than the whole budget are not cached.
+    void put(const Key& key, Value value, size_t cost) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            used -= it->second->cost;
+            order.erase(it->second);
+            index.erase(it);
+        }
+        if (cost > capacity) return;
+
+        order.push_front(Entry{key, std::move(value), cost});
+        index[key] = order.begin();
+        used += cost;
+        evictLocked();
+    }
+
+    void erase(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end()) return;
+        used -= it->second->cost;
+        order.erase(it->second);
+        index.erase(it);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.clear();
+        index.clear();
+        used = 0;
+    }
+
+    void setCapacity(size_t capacityBytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        capacity = capacityBytes;
+        evictLocked();
+    }
+
+    CacheStats getStats() const {
+        CacheStats stats;
+        stats.hits = hits.load(std::memory_order_relaxed);
+        stats.misses = misses.load(std::memory_order_relaxed);
+        stats.evictions = evictions.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.entries = index.size();
+        stats.usedBytes = used;
+        stats.capacityBytes = capacity;
+        return stats;
+    }
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// Read-only view of a whole file. On POSIX systems the file is memory-mapped,
+// elsewhere its contents are read into an owned buffer.
+class MappedFile {
+private:
+    const char* mappedData = nullptr;
+    size_t mappedSize = 0;
+    std::string fallbackBuffer;
+    bool isMapped = false;
+
+public:
+    explicit MappedFile(const std::string& filePath);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return mappedData; }
+    size_t size() const { return mappedSize; }
+    std::string_view view() const { return std::string_view(mappedData, mappedSize); }
+};
@@ -0,0 +1,119 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Log-linear latency histogram in the style of HdrHistogram: every power of
+// two is split into SUB_BUCKETS linear buckets, so any recorded value is
+// known to within 1/SUB_BUCKETS (12.5%) while the whole range from 1 ns to
+// about 3 days fits in a few hundred counters.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr uint64_t SUB_BUCKETS = uint64_t(1) << SUB_BUCKET_BITS;
+    static constexpr int MAX_EXPONENT = 47;  // values >= 2^48 ns land in the last bucket
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    static size_t bucketIndex(uint64_t value);
+    // Largest value that falls into bucket index
+    static uint64_t bucketUpperBound(size_t index);
+
+    void record(uint64_t value) { add(bucketIndex(value), 1, value); }
+    void add(size_t bucket, uint64_t count, uint64_t sum);
+    void merge(const LatencyHistogram& other);
+
+    uint64_t getCount() const { return count; }
+    uint64_t getSum() const { return sum; }
+    uint64_t getBucket(size_t index) const { return buckets[index]; }
+    // Number of recorded values <= value (exact at bucket boundaries)
+    uint64_t countAtOrBelow(uint64_t value) const;
+    // Upper bound of the bucket holding quantile q (0..1); 0 when empty
+    uint64_t quantile(double q) const;
+
+private:
+    std::array<uint64_t, BUCKET_COUNT> buckets{};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+};
+
+// Process-wide instrumentation. Every thread records into its own shard of
+// relaxed atomics, so the hot path never takes a lock or shares a cache
+// line; a scrape sums the shards. Shards of exited threads are folded into
+// a retired total, so nothing recorded is lost.
+class Metrics {
+public:
+    // Instrumented HTTP routes
+    enum class Route {
+        Root,
+        GetStock,
+        AppendBars,
+        Predict,
+        PredictBatch,
+        Backtest,
+        Sweep,
+        Analyze,
+        Algorithms,
+        CacheStats,
+        Metrics,
+        Ready,
+        Symbols,
+        Test,
+        Options,
+        Count
+    };
+
+    // Timed stages inside requests
+    enum class Stage {
+        CsvParse,
+        SnapshotLoad,
+        AlgorithmCompute,
+        JsonSerialize,
+        PredictionWrite,
+        Compress,
+        Count
+    };
+
+    enum class Counter {
+        CsvRowsParsed,
+        CsvBytesParsed,
+        AlgorithmRows,
+        ArenaSpillBytes,
+        CompressInputBytes,
+        CompressOutputBytes,
+        Count
+    };
+
+    static void add(Counter counter, uint64_t amount = 1);
+    static void recordStage(Stage stage, uint64_t nanoseconds);
+    static void recordRequest(Route route, uint64_t nanoseconds, uint64_t bytesIn, uint64_t bytesOut, bool failed);
+    // Body bytes written after the handler returned (chunked responses)
+    static void addBytesOut(Route route, uint64_t bytes);
+
+    static const char* routeMethod(Route route);
+    static const char* routePath(Route route);
+    static const char* stageName(Stage stage);
+
+    // Appends every metric above in Prometheus text exposition format
+    static void writePrometheus(std::string& out);
+
+    // Records the lifetime of the enclosing scope under a stage
+    class ScopedTimer {
+    private:
+        Stage stage;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit ScopedTimer(Stage timedStage) : stage(timedStage), start(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() { recordStage(stage, elapsedSince(start)); }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    };
+
+    static uint64_t elapsedSince(std::chrono::steady_clock::time_point start) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include "PriceSeries.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Predictions of many SMA windows and EMA alphas over the same bars, one
+// row per setting. Every row covers the same columns bars starting at
+// firstBar.
+struct SweepResult {
+    std::shared_ptr<const PriceSeries> series;
+    size_t firstBar = 0;
+    size_t columns = 0;
+    std::vector<int> windows;
+    std::vector<double> alphas;
+    std::vector<double> sma;  // windows.size() x columns, row-major
+    std::vector<double> ema;  // alphas.size() x columns, row-major
+
+    const double* smaRow(size_t k) const { return sma.data() + k * columns; }
+    const double* emaRow(size_t k) const { return ema.data() + k * columns; }
+};
+
+// Evaluates a whole parameter range at once instead of one predict() per
+// setting. SMA rows share one prefix-sum array, so each extra window costs
+// a subtraction per bar; EMA alphas advance side by side in one pass over
+// the closes.
+class ParameterSweep {
+public:
+    // Upper bounds on settings per algorithm and on (windows + alphas) x columns
+    static constexpr size_t MAX_SETTINGS = 1000;
+    static constexpr size_t MAX_CELLS = 10000000;
+
+    // Sweeps bars [begin, end) of series. Columns start at the first bar the
+    // widest window can predict, so the matrix has no gaps. Each row matches
+    // the ranged prediction of its setting (to within rounding); EMA rows
+    // warm up from the longest warm-up among the alphas. Windows and alphas
+    // are validated by the algorithms themselves; limits throw
+    // std::invalid_argument.
+    static SweepResult run(std::shared_ptr<const PriceSeries> series, std::vector<int> windows,
+                           std::vector<double> alphas, size_t begin, size_t end);
+};
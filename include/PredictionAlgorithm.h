@@ -1,40 +1,87 @@
 #pragma once
-#include "Stock.h"
+#include "PriceSeries.h"
+#include "SeriesKernels.h"
+#include <memory>
 #include <vector>
 #include <string>
 #include <nlohmann/json.hpp>
 
+// Incremental form of an algorithm: consumes one close at a time in O(1).
+class OnlineState {
+public:
+    virtual ~OnlineState() = default;
+
+    // Restores the state reached after predict() ran over closes and
+    // produced predictions, so that update() continues the same series.
+    virtual void seed(ColumnView<double> closes, const std::vector<double>& predictions) = 0;
+
+    // Feeds the next close. Returns true and sets prediction once the state
+    // has enough history to produce a value.
+    virtual bool update(double close, double& prediction) = 0;
+};
+
+// Registered algorithms are immutable prototypes shared by all request
+// threads: predict() is const, and per-request parameters are applied to a
+// private copy obtained through withParameters().
 class PredictionAlgorithm {
 public:
     virtual ~PredictionAlgorithm() = default;
     
     // Pure virtual functions
-    virtual std::vector<double> predict(const std::vector<StockData>& data) = 0;
+    virtual std::vector<double> predict(const PriceSeries& data) const = 0;
     virtual std::string getName() const = 0;
     virtual std::string getDescription() const = 0;
+    virtual std::unique_ptr<PredictionAlgorithm> clone() const = 0;
     
     // Configuration
     virtual void configure(const nlohmann::json& params) = 0;
     virtual nlohmann::json getParameters() const = 0;
     virtual void validate() const = 0;
 
+    // predict() into a caller-owned buffer, so a caller running many
+    // predictions (backtests) can reuse one allocation. out is resized.
+    virtual void predictInto(const PriceSeries& data, std::vector<double>& out) const { out = predict(data); }
+
+    // Returns a configured copy; the prototype itself is never modified
+    std::unique_ptr<PredictionAlgorithm> withParameters(const nlohmann::json& params) const;
+
+    // Incremental state for appending bars, or nullptr when the algorithm
+    // can only recompute from scratch
+    virtual std::unique_ptr<OnlineState> createOnlineState() const { return nullptr; }
+
+    // Leading bars that produce no prediction: prediction i belongs to bar
+    // i + getLookback()
+    virtual size_t getLookback() const { return 0; }
+
+    // Bars of history needed before a bar for its prediction to match one
+    // computed over the full series (to within rounding, for algorithms
+    // with unbounded memory). Range requests compute from that far back.
+    virtual size_t getWarmup() const { return getLookback(); }
+
 protected:
     // Utility functions for derived classes
-    std::vector<double> getClosingPrices(const std::vector<StockData>& data);
+    static ColumnView<double> getClosingPrices(const PriceSeries& data) { return data.getCloses(); }
 };
 
 // Concrete implementations
 class MovingAverageAlgorithm : public PredictionAlgorithm {
 private:
     int windowSize;
+    // Compile-time specialised kernel for windowSize, looked up whenever the
+    // window changes; nullptr falls back to the rolling-sum kernel
+    SeriesKernels::WindowMeanFn meanKernel = nullptr;
     static constexpr int MIN_WINDOW = 2;
     static constexpr int MAX_WINDOW = 200;
 
 public:
     explicit MovingAverageAlgorithm(int window = 5);
-    std::vector<double> predict(const std::vector<StockData>& data) override;
+    std::vector<double> predict(const PriceSeries& data) const override;
+    void predictInto(const PriceSeries& data, std::vector<double>& out) const override;
     std::string getName() const override { return "SMA"; }
     std::string getDescription() const override;
+    std::unique_ptr<PredictionAlgorithm> clone() const override;
+    std::unique_ptr<OnlineState> createOnlineState() const override;
+    size_t getLookback() const override { return static_cast<size_t>(windowSize) - 1; }
     
     void configure(const nlohmann::json& params) override;
     nlohmann::json getParameters() const override;
@@ -49,9 +96,13 @@ private:
 
 public:
     explicit ExponentialMovingAverageAlgorithm(double alpha = 0.2);
-    std::vector<double> predict(const std::vector<StockData>& data) override;
+    std::vector<double> predict(const PriceSeries& data) const override;
+    void predictInto(const PriceSeries& data, std::vector<double>& out) const override;
     std::string getName() const override { return "EMA"; }
     std::string getDescription() const override;
+    std::unique_ptr<PredictionAlgorithm> clone() const override;
+    std::unique_ptr<OnlineState> createOnlineState() const override;
+    size_t getWarmup() const override;
     
     void configure(const nlohmann::json& params) override;
     nlohmann::json getParameters() const override;
@@ -0,0 +1,74 @@
+#pragma once
+#include "FileHandler.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct PersistStats {
+    uint64_t queued = 0;     // accepted by enqueue()
+    uint64_t coalesced = 0;  // replaced a newer result for a symbol still waiting
+    uint64_t dropped = 0;    // rejected because the queue was full
+    uint64_t written = 0;
+    uint64_t failed = 0;
+    size_t pending = 0;
+};
+
+// Write-behind persistence for prediction files. Requests hand their result
+// to enqueue() and return immediately; one background thread writes the
+// files. At most one write per symbol is waiting at a time, so a burst of
+// requests for a symbol costs a single write of the latest result.
+class PredictionWriter {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+private:
+    // The series a result was computed from travels with it, so the dates
+    // written are those of the bars the predictions belong to
+    struct Job {
+        std::shared_ptr<const PriceSeries> series;
+        size_t firstBar = 0;
+        std::shared_ptr<const std::vector<double>> predictions;
+    };
+
+    FileHandler& fileHandler;
+    size_t capacity;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable drained;
+    std::deque<std::string> order;
+    std::unordered_map<std::string, Job> pending;
+    bool writing = false;
+    bool stopping = false;
+    PersistStats stats;
+
+    std::thread worker;
+
+    void run();
+    void write(const std::string& symbol, const Job& job);
+
+public:
+    explicit PredictionWriter(FileHandler& handler, size_t queueCapacity = DEFAULT_CAPACITY);
+    // Writes everything still queued before returning
+    ~PredictionWriter();
+
+    PredictionWriter(const PredictionWriter&) = delete;
+    PredictionWriter& operator=(const PredictionWriter&) = delete;
+
+    // Queues predictions computed from series, whose first value belongs to
+    // bar firstBar. Returns false when the queue is full and the result was
+    // not queued.
+    bool enqueue(const std::string& symbol, std::shared_ptr<const PriceSeries> series, size_t firstBar,
+                 std::shared_ptr<const std::vector<double>> predictions);
+
+    // Blocks until every queued write has finished
+    void flush();
+
+    PersistStats getStats() const;
+};
@@ -0,0 +1,133 @@
+#pragma once
+#include "Stock.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+// Read-only view over a contiguous column; never owns its data
+template <typename T>
+class ColumnView {
+private:
+    const T* ptr = nullptr;
+    size_t count = 0;
+
+public:
+    ColumnView() = default;
+    ColumnView(const T* data, size_t size) : ptr(data), count(size) {}
+    ColumnView(const std::vector<T>& values) : ptr(values.data()), count(values.size()) {}
+
+    const T* data() const { return ptr; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    const T& operator[](size_t index) const { return ptr[index]; }
+    const T& front() const { return ptr[0]; }
+    const T& back() const { return ptr[count - 1]; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + count; }
+
+    ColumnView subview(size_t offset, size_t length) const {
+        if (offset > count) offset = count;
+        if (length > count - offset) length = count - offset;
+        return ColumnView(ptr + offset, length);
+    }
+};
+
+// Columnar (structure-of-arrays) price history for a single symbol.
+// The symbol is stored once and dates are packed into one character buffer;
+// each date is also kept parsed as UTC epoch seconds, which are strictly
+// increasing, so a row costs five doubles, one int64 and its date characters.
+//
+// A series either owns its columns (built row by row with append) or views
+// columns that live elsewhere, such as a memory-mapped snapshot file kept
+// alive by the series.
+class PriceSeries {
+public:
+    // Columns laid out in external memory; all arrays hold `rows` entries
+    // except dateOffsets, which holds rows + 1.
+    struct ExternalColumns {
+        size_t rows = 0;
+        const double* opens = nullptr;
+        const double* highs = nullptr;
+        const double* lows = nullptr;
+        const double* closes = nullptr;
+        const double* volumes = nullptr;
+        const int64_t* timestamps = nullptr;
+        const uint32_t* dateOffsets = nullptr;
+        const char* dateChars = nullptr;
+    };
+
+private:
+    std::string symbol;
+    std::vector<double> opens;
+    std::vector<double> highs;
+    std::vector<double> lows;
+    std::vector<double> closes;
+    std::vector<double> volumes;
+    std::vector<int64_t> timestamps;
+    std::string dateChars;
+    std::vector<uint32_t> dateOffsets{0};
+
+    ExternalColumns external;
+    std::shared_ptr<const void> externalOwner;
+    size_t externalBytes = 0;
+
+    bool isExternal() const { return externalOwner != nullptr; }
+
+public:
+    PriceSeries() = default;
+    explicit PriceSeries(std::string symbol);
+
+    // Views columns owned by `owner`; ownerBytes is what the owner holds in memory
+    PriceSeries(std::string symbol, const ExternalColumns& columns,
+                std::shared_ptr<const void> owner, size_t ownerBytes);
+
+    void reserve(size_t rows);
+    // timestamp is date parsed by DateTime::parse and must be later than the
+    // previous row's; throws std::invalid_argument otherwise
+    void append(std::string_view date, int64_t timestamp,
+                double open, double high, double low, double close, double volume);
+
+    // Rows [begin, end) of series as a new series that shares its storage
+    // and keeps it alive
+    static PriceSeries slice(const std::shared_ptr<const PriceSeries>& series, size_t begin, size_t end);
+
+    // Getters
+    const std::string& getSymbol() const { return symbol; }
+    size_t size() const { return isExternal() ? external.rows : closes.size(); }
+    bool empty() const { return size() == 0; }
+
+    std::string_view getDate(size_t index) const;
+    ColumnView<double> getOpens() const { return column(opens, external.opens); }
+    ColumnView<double> getHighs() const { return column(highs, external.highs); }
+    ColumnView<double> getLows() const { return column(lows, external.lows); }
+    ColumnView<double> getCloses() const { return column(closes, external.closes); }
+    ColumnView<double> getVolumes() const { return column(volumes, external.volumes); }
+    ColumnView<int64_t> getTimestamps() const {
+        return isExternal() ? ColumnView<int64_t>(external.timestamps, external.rows) : ColumnView<int64_t>(timestamps);
+    }
+
+    // Packed date column: date i is dateChars[offsets[i] - offsets[0] ..
+    // offsets[i + 1] - offsets[0]); offsets[0] is non-zero only for slices
+    ColumnView<uint32_t> getDateOffsets() const;
+    std::string_view getDateChars() const;
+
+    // Index of the first row at or after timestamp, or size() if there is
+    // none; O(log n)
+    size_t lowerBound(int64_t timestamp) const;
+
+    // Materialises a single row; meant for display, not for hot loops
+    StockData row(size_t index) const;
+
+    // Approximate memory footprint in bytes, including any external storage
+    size_t memoryUsage() const;
+
+private:
+    ColumnView<double> column(const std::vector<double>& owned, const double* viewed) const {
+        return isExternal() ? ColumnView<double>(viewed, external.rows) : ColumnView<double>(owned);
+    }
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+
+// Scratch memory for one request. Every thread owns a block that is reused
+// from request to request: the arena hands it out through a
+// std::pmr::monotonic_buffer_resource, so an allocation is a pointer bump,
+// a deallocation does nothing, and everything is released when the arena
+// goes out of scope. A request that outgrows the block spills to the heap,
+// and the thread's next block is sized to fit it (up to MAX_BLOCK_BYTES).
+//
+// While an arena is alive, current() returns it, so code deep inside a
+// request (algorithm scratch buffers) can allocate from it without the
+// resource being passed down. Nothing allocated from an arena may outlive
+// it; results that are cached or returned stay on the heap.
+class RequestArena {
+private:
+    // Forwards to the heap and counts what the arena could not hold
+    class SpillResource : public std::pmr::memory_resource {
+    public:
+        size_t bytes = 0;
+
+    private:
+        void* do_allocate(size_t size, size_t alignment) override;
+        void do_deallocate(void* pointer, size_t size, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    SpillResource spill;
+    std::optional<std::pmr::monotonic_buffer_resource> arena;
+    RequestArena* outer;
+    bool ownsBlock;
+
+public:
+    static constexpr size_t INITIAL_BLOCK_BYTES = 64 * 1024;
+    static constexpr size_t MAX_BLOCK_BYTES = 16 * 1024 * 1024;
+
+    // An arena opened while another one is alive on the same thread starts
+    // empty instead of sharing the thread's block
+    RequestArena();
+    ~RequestArena();
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &*arena; }
+    // Bytes this arena has had to take from the heap so far
+    size_t spilledBytes() const { return spill.bytes; }
+
+    // Innermost live arena on this thread, or the heap when there is none
+    static std::pmr::memory_resource* current();
+};
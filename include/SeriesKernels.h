@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+
+// Numeric kernels shared by the prediction algorithms. Entry points pick the
+// widest instruction set the CPU supports once, at first use.
+class SeriesKernels {
+public:
+    // Moving sums are re-seeded from scratch this often (in output points)
+    // so rounding error cannot build up across long series.
+    static constexpr size_t RESUM_INTERVAL = 4096;
+
+    // out[i] = mean(values[i .. i + window)) for i in [0, count - window].
+    // out must have room for count - window + 1 values.
+    static void rollingMean(const double* values, size_t count, size_t window, double* out);
+
+    // Portable reference implementation of rollingMean
+    static void rollingMeanScalar(const double* values, size_t count, size_t window, double* out);
+
+    // Means over a window size fixed at compile time: out[i] = mean of
+    // values[i .. i + window) for i in [0, count - window], count >= window
+    using WindowMeanFn = void (*)(const double* values, size_t count, double* out);
+
+    // Kernel specialised for window (see WindowKernels), or nullptr when
+    // that size has none. Resolve it once and call it per series; the
+    // specialised windows are 5, 10, 20, 50, 100 and 200.
+    static WindowMeanFn fixedWindowMean(size_t window);
+
+    // Running totals for prefix-sum window means: sums[i] + errors[i] is the
+    // sum of values[0 .. i) carried to about twice double precision. Both
+    // arrays need count + 1 slots.
+    static void prefixSums(const double* values, size_t count, double* sums, double* errors);
+
+    // out[i] = mean of the window values starting at i, for i in
+    // [0, outputs), from prefixSums output covering outputs + window - 1
+    // values. Any window costs one subtraction per output.
+    static void windowMeans(const double* sums, const double* errors, size_t window, double* out, size_t outputs);
+
+    // One EMA per alpha over the same values, seeded with values[0] as
+    // ExponentialMovingAverageAlgorithm does. Bars before skip only warm the
+    // state; row k of out (row length count - skip) holds alpha k from bar
+    // skip on. Alphas advance side by side, so the values are read once.
+    static void exponentialMeans(const double* values, size_t count, const double* alphas, size_t alphaCount,
+                                 size_t skip, double* out);
+
+    // Element-wise stages of the technical indicators. Each output depends
+    // only on the inputs at the same index, so they run at full vector width.
+
+    // gains[i] and losses[i] are the rise and fall from values[i] to
+    // values[i + 1] (one of them is 0). values holds count + 1 entries.
+    static void priceChanges(const double* values, size_t count, double* gains, double* losses);
+
+    // out[i] = max(high - low, |high - previous close|, |low - previous close|)
+    static void trueRanges(const double* highs, const double* lows, const double* previousCloses, size_t count,
+                           double* out);
+
+    // out[i] = 100 * gain / (gain + loss), or 50 when both are 0
+    static void relativeStrength(const double* averageGains, const double* averageLosses, size_t count, double* out);
+
+    // out[i] = means[i] + width * sqrt(variances[i]), with negative
+    // variances (rounding) read as 0
+    static void bands(const double* means, const double* variances, size_t count, double width, double* out);
+
+    // First-order linear recurrence, the core of EMA and Wilder smoothing:
+    // out[i] = state = decay * state + gain * inputs[i], continuing from and
+    // updating state. powers must hold decay^j for j in [0, count / 4]
+    // (decayPowers). The vector path runs four stretches of the inputs at
+    // once, each starting from 0, then adds the state carried into each
+    // stretch times decay^(j + 1); it matches the plain loop to within
+    // rounding.
+    static void linearRecurrence(const double* inputs, size_t count, double decay, double gain,
+                                 const double* powers, double& state, double* out);
+
+    // powers[j] = decay^j for j in [0, count)
+    static void decayPowers(double decay, size_t count, double* powers);
+
+    // "avx2" or "scalar"
+    static const char* activeInstructionSet();
+};
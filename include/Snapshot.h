@@ -0,0 +1,47 @@
+#pragma once
+#include "PriceSeries.h"
+#include <cstdint>
+#include <string>
+
+// On-disk header of a binary price snapshot (SYMBOL.bin).
+//
+// All integers and doubles are little-endian. The header is followed by
+// eight columns, each starting on a 64-byte boundary so the file can be
+// memory-mapped and used in place:
+//   open, high, low, close, volume  double[rowCount]
+//   timestamps (epoch seconds)      int64[rowCount], strictly increasing
+//   date offsets                    uint32[rowCount + 1]
+//   date characters                 char[dateCharsSize]
+//
+// Version 1 files (128-byte header, no timestamp column) are still read;
+// their timestamps are parsed from the dates at load time.
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t rowCount;
+    uint64_t dateCharsSize;
+    char symbol[32];
+    uint64_t columnOffsets[8];
+    uint64_t fileSize;
+    uint64_t reserved[7];  // zero
+};
+static_assert(sizeof(SnapshotHeader) == 192, "snapshot header layout changed");
+
+class Snapshot {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 2;
+    static constexpr size_t COLUMN_ALIGNMENT = 64;
+    static constexpr const char* FILE_EXTENSION = ".bin";
+
+    // Writes series to path atomically (temporary file, then rename)
+    static void write(const PriceSeries& series, const std::string& path);
+
+    // Maps path and returns a series viewing the mapped columns. Checks the
+    // layout and that the date column is monotonic.
+    static PriceSeries load(const std::string& path);
+
+    // Loads path and additionally checks that every price is finite.
+    // Throws std::runtime_error describing the first problem found.
+    static PriceSeries verify(const std::string& path);
+};
@@ -1,29 +1,242 @@
 #pragma once
+#include "Backtester.h"
 #include "FileHandler.h"
+#include "Indicators.h"
+#include "LruCache.h"
+#include "ParameterSweep.h"
 #include "PredictionAlgorithm.h"
+#include "PredictionWriter.h"
+#include "SymbolRegistry.h"
+#include "TaskScheduler.h"
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <map>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+// One algorithm (with optional per-request parameters) in a batch request
+struct AlgorithmSpec {
+    std::string name;
+    nlohmann::json parameters;
+};
+
+// Outcome of one algorithm for one symbol in a batch
+struct BatchPrediction {
+    std::string algorithm;
+    std::vector<double> predictions;
+    std::string error;
+};
+
+// All outcomes for one symbol; error is set when the symbol could not be loaded
+struct BatchSymbolResult {
+    size_t index = 0;  // position of the symbol in the request
+    std::string symbol;
+    std::vector<BatchPrediction> results;
+    std::string error;
+    double elapsedMs = 0.0;
+    // The series the predictions were computed from; predictions[i] of an
+    // algorithm belongs to bar lookback + i
+    std::shared_ptr<const PriceSeries> series;
+};
+
+// Score of one (symbol, algorithm spec) pair in a backtest
+struct BacktestRun {
+    BacktestMetrics metrics;
+    std::string error;
+    double elapsedMs = 0.0;
+};
+
+// Predictions together with the bars they belong to
+struct PredictionWindow {
+    std::shared_ptr<const PriceSeries> series;
+    size_t firstBar = 0;  // predictions[i] belongs to series row firstBar + i
+    std::vector<double> predictions;
+};
 
 class StockPredictor {
+public:
+    static constexpr size_t DEFAULT_CACHE_BUDGET = 256 * 1024 * 1024;
+    // Share of the cache budget for computed predictions, split evenly
+    // between the live series and the result cache; parsed series get the rest
+    static constexpr size_t DEFAULT_PREDICTION_CACHE_PERCENT = 25;
+
+    // Called once per finished symbol, possibly from several threads at once.
+    // Returning false cancels symbols that have not started yet.
+    using BatchCallback = std::function<bool(BatchSymbolResult&&)>;
+
 private:
+    struct CachedSeries {
+        FileVersion version;
+        std::shared_ptr<const PriceSeries> series;
+        // Set for series the warm-up loaded; released with the entry
+        std::shared_ptr<const ResidentReservation> reservation;
+    };
+
+    // Predictions kept up to date incrementally as bars are appended
+    struct LiveSeries {
+        std::mutex mutex;
+        std::unique_ptr<OnlineState> state;
+        std::vector<double> predictions;
+        FileVersion version;
+    };
+
+    using AlgorithmMap = std::map<std::string, std::shared_ptr<const PredictionAlgorithm>>;
+
     std::unique_ptr<FileHandler> fileHandler;
-    std::map<std::string, std::unique_ptr<PredictionAlgorithm>> algorithms;
+    LruCache<std::string, CachedSeries> seriesCache;
+
+    // Read-copy-update registry: readers atomically load the current map and
+    // never block; registerAlgorithm publishes a modified copy.
+    std::shared_ptr<const AlgorithmMap> algorithms;
+    std::mutex registryWriteMutex;
+
+    std::unique_ptr<TaskScheduler> scheduler;
+
+    // Keyed by symbol, algorithm and canonical parameters; liveBySymbol lets
+    // appendBars find every live series of a symbol (evicted ones expire)
+    LruCache<std::string, std::shared_ptr<LiveSeries>> liveSeries;
+    std::mutex liveIndexMutex;
+    std::unordered_map<std::string, std::vector<std::weak_ptr<LiveSeries>>> liveBySymbol;
+
+    // Finished predictions keyed by symbol, algorithm, canonical parameters
+    // and data version; a new file version simply stops matching
+    LruCache<std::string, std::shared_ptr<const std::vector<double>>> resultCache;
+
+    // Serialises appends per symbol
+    std::mutex appendLocksMutex;
+    std::unordered_map<std::string, std::shared_ptr<std::mutex>> appendLocks;
+
+    SymbolRegistry registry;
+    std::thread warmupThread;
+    std::atomic<bool> stopWarmup{false};
+
+    // Declared last so it is drained and joined while fileHandler, which it
+    // writes through, is still alive
+    std::unique_ptr<PredictionWriter> predictionWriter;
 
 public:
-    explicit StockPredictor(const std::string& dataDir);
+    // batchThreads 0 uses one worker per hardware thread. cacheBudgetBytes
+    // bounds all three caches together; predictionCachePercent (0-100) of it
+    // goes to computed predictions.
+    explicit StockPredictor(const std::string& dataDir, size_t cacheBudgetBytes = DEFAULT_CACHE_BUDGET,
+                            size_t batchThreads = 0,
+                            size_t predictionCachePercent = DEFAULT_PREDICTION_CACHE_PERCENT);
+    // Stops a running warm-up before anything it uses goes away
+    ~StockPredictor();
 
     // Core operations
-    std::vector<StockData> getHistoricalData(const std::string& symbol);
-    std::vector<double> predict(const std::string& symbol, const std::string& algorithm);
+    // Parsed series are cached per symbol until the backing file changes
+    std::shared_ptr<const PriceSeries> getHistoricalData(const std::string& symbol);
+    // params (a JSON object, or null for defaults) apply to this call only.
+    // The window holds the series snapshot the predictions were computed
+    // from. With persist, the result is queued for SYMBOL_predictions.csv;
+    // the file is written in the background.
+    PredictionWindow predict(const std::string& symbol, const std::string& algorithm,
+                             const nlohmann::json& params = nullptr, bool persist = true);
+    // Predictions for the bars with timestamps in [from, to) only. The
+    // algorithm runs over those bars plus its warm-up history; results are
+    // neither cached nor persisted.
+    PredictionWindow predictRange(const std::string& symbol, const std::string& algorithm,
+                                  const nlohmann::json& params, int64_t from, int64_t to);
+    // Strong ETags (quoted) that change whenever the symbol's data file
+    // changes; prediction tags also cover the algorithm and its parameters.
+    // Both only stat the file, so they are cheap enough to check before
+    // doing any work.
+    std::string getDataTag(const std::string& symbol);
+    // variant tells apart responses built from the same prediction, such
+    // as different date ranges.
+    std::string getPredictionTag(const std::string& symbol, const std::string& algorithm,
+                                 const nlohmann::json& params = nullptr, const std::string& variant = "");
+
+    // Runs an algorithm on data that is already in memory (e.g. an upload);
+    // nothing is read from or written to the data directory
+    std::vector<double> predict(const PriceSeries& data, const std::string& algorithm,
+                                const nlohmann::json& params = nullptr) const;
     std::vector<std::string> getAvailableAlgorithms() const;
+    // Runs every spec over the same in-memory series and returns one entry
+    // per spec, in order; failures (including unknown algorithms) are
+    // reported in the entry. With a limit, only the first limit predictions
+    // of each are computed: the series is trimmed once to the bars they
+    // depend on. Indicators share one fused pass. Nothing is cached or
+    // persisted.
+    std::vector<BatchPrediction> analyze(const std::shared_ptr<const PriceSeries>& data,
+                                         const std::vector<AlgorithmSpec>& specs, size_t limit = 0);
+
+    // Appends bars to the symbol's CSV and advances every live prediction
+    // series of the symbol in O(1) per bar. Returns the number of live series
+    // updated. Throws std::invalid_argument unless the bars are dated after
+    // the last stored bar.
+    size_t appendBars(const std::string& symbol, const PriceSeries& bars);
+
+    // Runs every algorithm on every symbol across the scheduler's workers.
+    // Each symbol is loaded once; failures are reported per symbol and per
+    // algorithm instead of failing the batch. Unknown algorithms throw
+    // before any work starts.
+    void predictBatch(const std::vector<std::string>& symbols, const std::vector<AlgorithmSpec>& specs,
+                      const BatchCallback& onResult, bool persist = true);
+    size_t getBatchThreadCount() const { return scheduler->getThreadCount(); }
+
+    // Scores every spec on every symbol over window, spread across the
+    // scheduler's workers; result symbol * specs.size() + spec belongs to
+    // that pair. Symbols are loaded once up front, each worker reuses its
+    // own prediction buffer, and failures are reported per pair. Unknown
+    // algorithms throw before any work starts.
+    std::vector<BacktestRun> backtest(const std::vector<std::string>& symbols, const std::vector<AlgorithmSpec>& specs,
+                                      const BacktestWindow& window);
+    // Every SMA window and EMA alpha in one pass over the symbol's bars
+    // dated in [from, to); see ParameterSweep. Nothing is cached or persisted.
+    SweepResult sweep(const std::string& symbol, std::vector<int> windows, std::vector<double> alphas,
+                      int64_t from, int64_t to);
+    // Every symbol in the data directory
+    std::vector<std::string> listSymbols() { return fileHandler->listSymbols(); }
+
+    // Loads every symbol in the data directory in the background, spread
+    // across the scheduler's workers, and records each in the registry.
+    // Series are kept in the cache until memoryCapBytes (at most the cache
+    // budget) is used; the rest are read for the registry only. Progress
+    // is reported by getWarmupProgress. Can be started once.
+    void startWarmup(size_t memoryCapBytes);
+    WarmupProgress getWarmupProgress() const { return registry.getProgress(); }
+    bool isReady() const { return registry.isReady(); }
+    // Symbols seen by the warm-up or read since, with their row counts,
+    // date ranges and file versions
+    std::vector<SymbolInfo> getSymbolInfo() const { return registry.list(); }
+
+    // Registered prototype, or a configured copy when params are given
+    std::shared_ptr<const PredictionAlgorithm> getAlgorithm(const std::string& name,
+                                                            const nlohmann::json& params = nullptr) const;
 
     // Algorithm management
     void registerAlgorithm(const std::string& name, std::unique_ptr<PredictionAlgorithm> algorithm);
     
     // Utility methods
     std::string getDataDirectory() const;
+    CacheStats getCacheStats() const { return seriesCache.getStats(); }
+    CacheStats getResultCacheStats() const { return resultCache.getStats(); }
+    CacheStats getLiveSeriesStats() const { return liveSeries.getStats(); }
+    PersistStats getPersistStats() const { return predictionWriter->getStats(); }
+    // Waits for queued prediction files to be written
+    void flushPredictions() { predictionWriter->flush(); }
 
 private:
     void initializeAlgorithms();
-};
\ No newline at end of file
+    void warmUp();
+    static SymbolInfo describe(const std::string& symbol, const FileVersion& version, const PriceSeries& series);
+    std::shared_ptr<const PriceSeries> loadSeries(const std::string& symbol, FileVersion& version);
+    void registerLiveSeries(const std::string& symbol, const std::shared_ptr<LiveSeries>& live);
+    void cacheResult(const std::string& key, const FileVersion& version,
+                     const std::shared_ptr<const std::vector<double>>& predictions);
+    // Runs an algorithm under the compute timer
+    static std::vector<double> compute(const PredictionAlgorithm& algo, const PriceSeries& data);
+    // Runs indicators in one fused pass under the compute timer
+    static void computeIndicators(const std::vector<const Indicator*>& indicators, const PriceSeries& data,
+                                  const std::vector<std::vector<double>*>& outputs);
+
+    static std::string predictionKey(const std::string& symbol, const std::string& algorithm,
+                                     const PredictionAlgorithm& algo);
+    static std::string versionString(const FileVersion& version);
+    static std::string makeETag(const std::string& key);
+};
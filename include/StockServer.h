@@ -0,0 +1,75 @@
+#pragma once
+#include "LruCache.h"
+#include "Metrics.h"
+#include "StockPredictor.h"
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include "httplib.h"
+#include <memory>
+#include <string>
+
+// HTTP front end: owns the httplib server and maps each route onto a
+// handler that works on a StockPredictor. The handlers are public so they
+// can also be driven in-process, without a socket (see bench/).
+class StockServer {
+public:
+    // Bodies smaller than this are sent uncompressed
+    static constexpr size_t DEFAULT_COMPRESS_MIN_BYTES = 1024;
+    static constexpr size_t COMPRESSED_CACHE_BUDGET = 64 * 1024 * 1024;
+
+private:
+    // A compressed body and the size it had before compression
+    struct CompressedBody {
+        std::string bytes;
+        size_t identityBytes = 0;
+    };
+
+    httplib::Server server;
+    std::unique_ptr<StockPredictor> predictor;
+    size_t compressMinBytes = DEFAULT_COMPRESS_MIN_BYTES;
+    // Compressed responses keyed by ETag, request target and coding; the
+    // ETag changes with the data, so stale entries simply stop matching
+    LruCache<std::string, std::shared_ptr<const CompressedBody>> compressedCache;
+
+public:
+    // workerThreads 0 keeps the httplib default; batchThreads 0 uses every hardware thread
+    StockServer(const std::string& dataDir, size_t cacheBudgetBytes, size_t workerThreads, size_t batchThreads,
+                size_t predictionCachePercent = StockPredictor::DEFAULT_PREDICTION_CACHE_PERCENT);
+
+    // Blocks serving requests until the server stops
+    void start(const std::string& host, int port);
+
+    StockPredictor& getPredictor() { return *predictor; }
+    void setCompressMinBytes(size_t bytes) { compressMinBytes = bytes; }
+    CacheStats getCompressedCacheStats() const { return compressedCache.getStats(); }
+
+    // Route handlers. Handlers for routes with a path parameter read it from
+    // req.matches[1].
+    void handleRoot(const httplib::Request& req, httplib::Response& res);
+    void handleGetStock(const httplib::Request& req, httplib::Response& res);
+    void handleAppendBars(const httplib::Request& req, httplib::Response& res);
+    void handlePredict(const httplib::Request& req, httplib::Response& res);
+    void handlePredictBatch(const httplib::Request& req, httplib::Response& res);
+    void handleBacktest(const httplib::Request& req, httplib::Response& res);
+    void handleSweep(const httplib::Request& req, httplib::Response& res);
+    void handleAnalyze(const httplib::Request& req, httplib::Response& res);
+    void handleListAlgorithms(const httplib::Request& req, httplib::Response& res);
+    void handleCacheStats(const httplib::Request& req, httplib::Response& res);
+    void handleMetrics(const httplib::Request& req, httplib::Response& res);
+    void handleReady(const httplib::Request& req, httplib::Response& res);
+    void handleListSymbols(const httplib::Request& req, httplib::Response& res);
+    void handleTest(const httplib::Request& req, httplib::Response& res);
+    void handleOptions(const httplib::Request& req, httplib::Response& res);
+
+private:
+    using Handler = void (StockServer::*)(const httplib::Request&, httplib::Response&);
+
+    void setupRoutes();
+    // Wraps a handler so its latency and body sizes are recorded under route
+    httplib::Server::Handler instrument(Metrics::Route route, Handler handler);
+    // Applies the coding negotiated from Accept-Encoding to the finished
+    // response: whole bodies at least compressMinBytes long, and chunked
+    // bodies chunk by chunk. A compressed body's ETag gets the coding as a
+    // suffix. Compressed bytes of responses with an ETag are cached, so a
+    // repeat request reuses them instead of compressing again.
+    void encodeResponse(const httplib::Request& req, httplib::Response& res, Metrics::Route route);
+};
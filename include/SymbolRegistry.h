@@ -0,0 +1,98 @@
+#pragma once
+#include "FileHandler.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+// What is known about one symbol's data, as of the last time it was read
+struct SymbolInfo {
+    std::string symbol;
+    FileVersion version;
+    size_t rows = 0;
+    int64_t firstTimestamp = 0;  // epoch seconds; 0 when rows is 0
+    int64_t lastTimestamp = 0;
+    size_t memoryBytes = 0;
+    std::string error;  // set when the file could not be read
+};
+
+enum class WarmupState { Disabled, Scanning, Loading, Ready };
+
+struct WarmupProgress {
+    WarmupState state = WarmupState::Disabled;
+    size_t symbolsTotal = 0;
+    size_t symbolsDone = 0;
+    size_t symbolsResident = 0;  // loaded by the warm-up and still in the series cache
+    size_t symbolsFailed = 0;
+    size_t residentBytes = 0;    // memory of those symbols
+    size_t memoryCapBytes = 0;
+    double elapsedMs = 0.0;
+};
+
+class SymbolRegistry;
+
+// Part of the warm-up memory cap held by one cached series. It is given back
+// when the last copy goes away, which is when the series cache drops the
+// entry it was stored with.
+class ResidentReservation {
+private:
+    SymbolRegistry& registry;
+    size_t bytes;
+
+public:
+    ResidentReservation(SymbolRegistry& owner, size_t reservedBytes) : registry(owner), bytes(reservedBytes) {}
+    ~ResidentReservation();
+
+    ResidentReservation(const ResidentReservation&) = delete;
+    ResidentReservation& operator=(const ResidentReservation&) = delete;
+};
+
+// Index of the symbols in the data directory, filled in by the startup
+// warm-up and refreshed whenever a series is parsed again. Also tracks the
+// warm-up's progress for the readiness endpoint. Thread-safe.
+class SymbolRegistry {
+private:
+    mutable std::mutex mutex;
+    std::map<std::string, SymbolInfo> symbols;
+
+    std::atomic<WarmupState> state{WarmupState::Disabled};
+    std::atomic<size_t> symbolsTotal{0};
+    std::atomic<size_t> symbolsDone{0};
+    std::atomic<size_t> symbolsResident{0};
+    std::atomic<size_t> symbolsFailed{0};
+    std::atomic<size_t> residentBytes{0};
+    std::atomic<size_t> memoryCapBytes{0};
+    std::chrono::steady_clock::time_point startedAt;
+    std::atomic<int64_t> elapsedNs{-1};  // set when the warm-up finishes
+
+    friend class ResidentReservation;
+    void releaseResident(size_t bytes);
+
+public:
+    // Replaces the entry for info.symbol
+    void update(SymbolInfo info);
+    std::optional<SymbolInfo> find(const std::string& symbol) const;
+    // Every entry, sorted by symbol
+    std::vector<SymbolInfo> list() const;
+
+    // Warm-up bookkeeping, called by StockPredictor in this order
+    void beginWarmup(size_t capBytes);
+    void beginLoading(size_t total);
+    // Reserves bytes of the memory cap for one series, until the returned
+    // reservation is destroyed; null (and nothing reserved) when they do
+    // not fit
+    std::shared_ptr<const ResidentReservation> reserveResident(size_t bytes);
+    // Counts one finished symbol and records its entry
+    void warmed(SymbolInfo info);
+    void finishWarmup();
+
+    WarmupProgress getProgress() const;
+    // True unless a warm-up is still running
+    bool isReady() const;
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads with per-worker task deques. A worker pops
+// from the back of its own deque and, when that is empty, steals from the
+// front of the others, so uneven tasks (short and long symbol histories)
+// still keep every core busy.
+class TaskScheduler {
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextQueue{0};
+    std::atomic<size_t> queuedTasks{0};
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void workerLoop(size_t index);
+    bool runOne(size_t preferredQueue);
+    void push(std::function<void()> task);
+
+public:
+    // threadCount 0 uses one worker per hardware thread
+    explicit TaskScheduler(size_t threadCount = 0);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    size_t getThreadCount() const { return workers.size(); }
+
+    // Runs body(i) for every i in [0, count) and returns when all are done.
+    // The calling thread works through queued tasks while it waits, so
+    // nested calls from inside a task cannot deadlock. The first exception
+    // thrown by body is rethrown here.
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define STOCK_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define STOCK_ALWAYS_INLINE inline
+#endif
+
+// Sliding-window means specialised at compile time for one window size and
+// value type (float or double). A window is a policy type whose sum()
+// writes the window sums starting at each position; wide windows are
+// composed from narrow ones, e.g. a 50-bar sum is five 10-bar sums taken
+// 10 apart. Every loop has constant trip counts and strides, so it unrolls
+// fully and vectorizes across outputs. Unlike a rolling sum there is no
+// carried state: nothing to compensate or re-seed, and no dependency
+// chain between outputs.
+//
+// Everything is inlined into the caller, so an instantiation inside a
+// function compiled for AVX2 uses AVX2 throughout (see SeriesKernels).
+namespace WindowKernels {
+    // Outputs computed per pass; the intermediate sums of one block stay in L1
+    constexpr size_t BLOCK = 1024;
+    // Widest window a composed sum may span. A level inside a window of
+    // width W is asked for up to BLOCK + W - 1 sums, so every level's
+    // scratch holds BLOCK + MAX_WINDOW.
+    constexpr size_t MAX_WINDOW = 256;
+
+    // Plain sum of N consecutive values
+    template <typename T, size_t N>
+    struct DirectSum {
+        using Value = T;
+        static constexpr size_t WINDOW = N;
+
+        // out[i] = (values[i] + ... + values[i + N - 1]) * scale for i in [0, count)
+        static STOCK_ALWAYS_INLINE void sum(const T* values, size_t count, T* out, T scale) {
+            for (size_t i = 0; i < count; ++i) {
+                T total = values[i];
+                for (size_t j = 1; j < N; ++j) {
+                    total += values[i + j];
+                }
+                out[i] = total * scale;
+            }
+        }
+    };
+
+    // Copies back-to-back windows of Inner
+    template <typename Inner, size_t Copies>
+    struct StridedSum {
+        using Value = typename Inner::Value;
+        static constexpr size_t WINDOW = Inner::WINDOW * Copies;
+        static_assert(WINDOW <= MAX_WINDOW, "composed window exceeds MAX_WINDOW");
+
+        // count must not exceed BLOCK + MAX_WINDOW - WINDOW
+        static STOCK_ALWAYS_INLINE void sum(const Value* values, size_t count, Value* out, Value scale) {
+            // Scaling by 1 folds away at compile time
+            Value partial[BLOCK + MAX_WINDOW];
+            Inner::sum(values, count + WINDOW - Inner::WINDOW, partial, Value(1));
+            for (size_t i = 0; i < count; ++i) {
+                Value total = partial[i];
+                for (size_t k = 1; k < Copies; ++k) {
+                    total += partial[i + k * Inner::WINDOW];
+                }
+                out[i] = total * scale;
+            }
+        }
+    };
+
+    // The window sizes used most. The factorisations were picked by timing:
+    // direct sums up to about 10 wide, then as few strided levels as fit.
+    template <typename T> using Window5 = DirectSum<T, 5>;
+    template <typename T> using Window10 = DirectSum<T, 10>;
+    template <typename T> using Window20 = StridedSum<Window10<T>, 2>;
+    template <typename T> using Window50 = StridedSum<Window10<T>, 5>;
+    template <typename T> using Window100 = StridedSum<Window20<T>, 5>;
+    template <typename T> using Window200 = StridedSum<StridedSum<DirectSum<T, 8>, 5>, 5>;
+
+    // out[i] = mean of Window::WINDOW values starting at values[i], for i in
+    // [0, count - WINDOW]; count must be at least WINDOW. The mean is the sum
+    // times 1 / WINDOW, which can differ from a division in the last bit.
+    template <typename Window>
+    STOCK_ALWAYS_INLINE void slidingMean(const typename Window::Value* values, size_t count,
+                                         typename Window::Value* out) {
+        using T = typename Window::Value;
+        const T scale = T(1) / static_cast<T>(Window::WINDOW);
+        const size_t outputs = count - Window::WINDOW + 1;
+        for (size_t start = 0; start < outputs; start += BLOCK) {
+            Window::sum(values + start, std::min(BLOCK, outputs - start), out + start, scale);
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#include "../include/Backtester.h"
+#include "../include/Metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+BacktestMetrics Backtester::evaluate(const PredictionAlgorithm& algo, const std::shared_ptr<const PriceSeries>& series,
+                                     const BacktestWindow& window, std::vector<double>& scratch) {
+    if (window.horizon == 0 || window.horizon > MAX_HORIZON) {
+        throw std::invalid_argument("Horizon must be between 1 and " + std::to_string(MAX_HORIZON));
+    }
+
+    BacktestMetrics metrics;
+    size_t begin = series->lowerBound(window.from);
+    size_t end = std::max(begin, series->lowerBound(window.to));
+
+    // Compute from far enough back that the first scored bar sees its full history
+    size_t lookback = algo.getLookback();
+    size_t warmup = std::max(algo.getWarmup(), lookback);
+    size_t start = begin > warmup ? begin - warmup : 0;
+    size_t first = std::max(begin, start + lookback);
+    if (end < window.horizon || first >= end - window.horizon) return metrics;
+
+    {
+        Metrics::ScopedTimer timer(Metrics::Stage::AlgorithmCompute);
+        Metrics::add(Metrics::Counter::AlgorithmRows, end - start);
+        algo.predictInto(PriceSeries::slice(series, start, end), scratch);
+    }
+
+    ColumnView<double> closes = series->getCloses();
+    size_t offset = start + lookback;  // scratch[t - offset] belongs to bar t
+    double absSum = 0.0;
+    double squareSum = 0.0;
+    double percentSum = 0.0;
+    size_t percentSteps = 0;
+    size_t hits = 0;
+
+    for (size_t t = first; t + window.horizon < end; ++t) {
+        double forecast = scratch[t - offset];
+        double actual = closes[t + window.horizon];
+        double error = forecast - actual;
+        absSum += std::abs(error);
+        squareSum += error * error;
+        if (actual != 0.0) {
+            percentSum += std::abs(error / actual);
+            ++percentSteps;
+        }
+
+        double move = actual - closes[t];
+        if (move != 0.0) {
+            ++metrics.directionalSteps;
+            if ((forecast - closes[t]) * move > 0.0) ++hits;
+        }
+        ++metrics.steps;
+    }
+
+    double steps = static_cast<double>(metrics.steps);
+    metrics.mae = absSum / steps;
+    metrics.rmse = std::sqrt(squareSum / steps);
+    metrics.mape = percentSteps ? 100.0 * percentSum / static_cast<double>(percentSteps) : 0.0;
+    metrics.hitRate = metrics.directionalSteps
+                          ? static_cast<double>(hits) / static_cast<double>(metrics.directionalSteps) : 0.0;
+    return metrics;
+}
+
+double Backtester::metric(const BacktestMetrics& metrics, const std::string& name) {
+    if (name == "mae") return metrics.mae;
+    if (name == "rmse") return metrics.rmse;
+    if (name == "mape") return metrics.mape;
+    if (name == "hit_rate") return metrics.hitRate;
+    throw std::invalid_argument("Unknown metric: " + name + " (expected mae, rmse, mape or hit_rate)");
+}
+
+bool Backtester::lowerIsBetter(const std::string& name) {
+    return name != "hit_rate";
+}
@@ -0,0 +1,145 @@
+#include "../include/BinaryWriter.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+    // CBOR major types
+    constexpr uint8_t CBOR_UNSIGNED = 0;
+    constexpr uint8_t CBOR_NEGATIVE = 1;
+    constexpr uint8_t CBOR_TEXT = 3;
+    constexpr uint8_t CBOR_ARRAY = 4;
+    constexpr uint8_t CBOR_MAP = 5;
+
+    // MessagePack length markers for 8, 16 and 32-bit lengths (0: no 8-bit form)
+    constexpr uint8_t MSGPACK_STRING[3] = {0xD9, 0xDA, 0xDB};
+    constexpr uint8_t MSGPACK_ARRAY[3] = {0, 0xDC, 0xDD};
+    constexpr uint8_t MSGPACK_MAP[3] = {0, 0xDE, 0xDF};
+}
+
+BinaryWriter::BinaryWriter(Format format, size_t reserveBytes, std::pmr::memory_resource* resource)
+    : format(format), buffer(resource) {
+    buffer.reserve(reserveBytes);
+}
+
+void BinaryWriter::appendBigEndian(uint64_t value, size_t bytes) {
+    for (size_t i = bytes; i-- > 0;) {
+        buffer += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void BinaryWriter::cborHead(uint8_t major, uint64_t argument) {
+    const char base = static_cast<char>(major << 5);
+    if (argument < 24) {
+        buffer += static_cast<char>(base | argument);
+    } else if (argument <= 0xFF) {
+        buffer += static_cast<char>(base | 24);
+        appendBigEndian(argument, 1);
+    } else if (argument <= 0xFFFF) {
+        buffer += static_cast<char>(base | 25);
+        appendBigEndian(argument, 2);
+    } else if (argument <= 0xFFFFFFFF) {
+        buffer += static_cast<char>(base | 26);
+        appendBigEndian(argument, 4);
+    } else {
+        buffer += static_cast<char>(base | 27);
+        appendBigEndian(argument, 8);
+    }
+}
+
+void BinaryWriter::msgpackHead(uint8_t fixBase, uint64_t fixLimit, const uint8_t (&markers)[3], uint64_t length) {
+    if (length < fixLimit) {
+        buffer += static_cast<char>(fixBase | length);
+    } else if (markers[0] != 0 && length <= 0xFF) {
+        buffer += static_cast<char>(markers[0]);
+        appendBigEndian(length, 1);
+    } else if (length <= 0xFFFF) {
+        buffer += static_cast<char>(markers[1]);
+        appendBigEndian(length, 2);
+    } else {
+        buffer += static_cast<char>(markers[2]);
+        appendBigEndian(length, 4);
+    }
+}
+
+BinaryWriter& BinaryWriter::beginArray(size_t count) {
+    if (format == Format::Cbor) cborHead(CBOR_ARRAY, count);
+    else msgpackHead(0x90, 16, MSGPACK_ARRAY, count);
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::beginObject(size_t pairs) {
+    if (format == Format::Cbor) cborHead(CBOR_MAP, pairs);
+    else msgpackHead(0x80, 16, MSGPACK_MAP, pairs);
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::value(double number) {
+    if (!std::isfinite(number)) return null();
+    uint64_t bits;
+    std::memcpy(&bits, &number, sizeof(bits));
+    buffer += static_cast<char>(format == Format::Cbor ? 0xFB : 0xCB);
+    appendBigEndian(bits, 8);
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::value(int64_t number) {
+    if (number >= 0) return value(static_cast<uint64_t>(number));
+    if (format == Format::Cbor) {
+        // -1 - n, computed without overflowing at INT64_MIN
+        cborHead(CBOR_NEGATIVE, ~static_cast<uint64_t>(number));
+    } else if (number >= -32) {
+        buffer += static_cast<char>(number);
+    } else if (number >= INT8_MIN) {
+        buffer += static_cast<char>(0xD0);
+        appendBigEndian(static_cast<uint64_t>(number), 1);
+    } else if (number >= INT16_MIN) {
+        buffer += static_cast<char>(0xD1);
+        appendBigEndian(static_cast<uint64_t>(number), 2);
+    } else if (number >= INT32_MIN) {
+        buffer += static_cast<char>(0xD2);
+        appendBigEndian(static_cast<uint64_t>(number), 4);
+    } else {
+        buffer += static_cast<char>(0xD3);
+        appendBigEndian(static_cast<uint64_t>(number), 8);
+    }
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::value(uint64_t number) {
+    if (format == Format::Cbor) {
+        cborHead(CBOR_UNSIGNED, number);
+    } else if (number < 0x80) {
+        buffer += static_cast<char>(number);
+    } else if (number <= 0xFF) {
+        buffer += static_cast<char>(0xCC);
+        appendBigEndian(number, 1);
+    } else if (number <= 0xFFFF) {
+        buffer += static_cast<char>(0xCD);
+        appendBigEndian(number, 2);
+    } else if (number <= 0xFFFFFFFF) {
+        buffer += static_cast<char>(0xCE);
+        appendBigEndian(number, 4);
+    } else {
+        buffer += static_cast<char>(0xCF);
+        appendBigEndian(number, 8);
+    }
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::value(bool flag) {
+    if (format == Format::Cbor) buffer += static_cast<char>(flag ? 0xF5 : 0xF4);
+    else buffer += static_cast<char>(flag ? 0xC3 : 0xC2);
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::value(std::string_view text) {
+    if (format == Format::Cbor) cborHead(CBOR_TEXT, text.size());
+    else msgpackHead(0xA0, 32, MSGPACK_STRING, text.size());
+    buffer.append(text.data(), text.size());
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::null() {
+    buffer += static_cast<char>(format == Format::Cbor ? 0xF6 : 0xC0);
+    return *this;
+}
@@ -0,0 +1,56 @@
+#include "../include/ColumnFrame.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    bool isLittleEndianHost() {
+        const uint16_t probe = 1;
+        unsigned char first;
+        std::memcpy(&first, &probe, 1);
+        return first == 1;
+    }
+}
+
+void ColumnFrame::appendHeader(std::pmr::string& out, uint8_t valueBytes, size_t columnCount, size_t rowCount,
+                               std::string_view metadata) {
+    if (!isLittleEndianHost()) {
+        throw std::runtime_error("Column responses are only supported on little-endian hosts");
+    }
+    if (valueBytes != 4 && valueBytes != 8) {
+        throw std::invalid_argument("Column values must be 4 or 8 bytes wide");
+    }
+
+    // Frames start on 8-byte boundaries; only a float32 frame with an odd
+    // row count leaves anything to pad
+    out.append((8 - out.size() % 8) % 8, '\0');
+
+    ColumnFrameHeader header = {};
+    std::memcpy(header.magic, "SCOL", 4);
+    header.version = FORMAT_VERSION;
+    header.valueBytes = valueBytes;
+    header.columnCount = static_cast<uint16_t>(columnCount);
+    header.metadataSize = static_cast<uint32_t>(metadata.size());
+    header.rowCount = rowCount;
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(metadata.data(), metadata.size());
+    // The header is 24 bytes, so padding the metadata aligns the columns to 8
+    out.append((8 - metadata.size() % 8) % 8, '\0');
+}
+
+void ColumnFrame::appendTimestamps(std::pmr::string& out, const int64_t* timestamps, size_t count) {
+    out.append(reinterpret_cast<const char*>(timestamps), count * sizeof(int64_t));
+}
+
+void ColumnFrame::appendValues(std::pmr::string& out, uint8_t valueBytes, const double* values, size_t count) {
+    if (valueBytes == 8) {
+        out.append(reinterpret_cast<const char*>(values), count * sizeof(double));
+        return;
+    }
+    size_t start = out.size();
+    out.resize(start + count * sizeof(float));
+    char* dest = out.data() + start;
+    for (size_t i = 0; i < count; ++i) {
+        float value = static_cast<float>(values[i]);
+        std::memcpy(dest + i * sizeof(float), &value, sizeof(float));
+    }
+}
@@ -0,0 +1,126 @@
+#include "../include/Compression.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace {
+    // zlib window bits; +16 asks for a gzip header and trailer instead of zlib's
+    constexpr int WINDOW_BITS = 15;
+    constexpr int GZIP_WINDOW_BITS = WINDOW_BITS + 16;
+    constexpr int MEMORY_LEVEL = 8;
+    constexpr size_t OUTPUT_STEP = 16 * 1024;
+
+    std::string_view trim(std::string_view text) {
+        size_t first = text.find_first_not_of(" \t");
+        if (first == std::string_view::npos) return {};
+        size_t last = text.find_last_not_of(" \t");
+        return text.substr(first, last - first + 1);
+    }
+
+    bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+ContentCoding Compression::negotiate(std::string_view acceptEncoding) {
+    ContentCoding best = ContentCoding::Identity;
+    double bestQuality = 0.0;
+    size_t pos = 0;
+    while (pos < acceptEncoding.size()) {
+        size_t end = acceptEncoding.find(',', pos);
+        if (end == std::string_view::npos) end = acceptEncoding.size();
+        std::string_view entry = acceptEncoding.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t paramsAt = entry.find(';');
+        std::string_view token = trim(entry.substr(0, paramsAt));
+        double quality = 1.0;
+        if (paramsAt != std::string_view::npos) {
+            std::string_view param = trim(entry.substr(paramsAt + 1));
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+                quality = std::strtod(std::string(param.substr(2)).c_str(), nullptr);
+            }
+        }
+
+        ContentCoding coding;
+        if (equalsIgnoreCase(token, "gzip") || equalsIgnoreCase(token, "x-gzip") || token == "*") {
+            coding = ContentCoding::Gzip;
+        } else if (equalsIgnoreCase(token, "deflate")) {
+            coding = ContentCoding::Deflate;
+        } else {
+            continue;
+        }
+        if (quality > bestQuality || (quality == bestQuality && quality > 0.0 && coding == ContentCoding::Gzip)) {
+            best = coding;
+            bestQuality = quality;
+        }
+    }
+    return best;
+}
+
+const char* Compression::name(ContentCoding coding) {
+    switch (coding) {
+        case ContentCoding::Gzip: return "gzip";
+        case ContentCoding::Deflate: return "deflate";
+        default: return "";
+    }
+}
+
+std::string Compression::compress(std::string_view body, ContentCoding coding, int level) {
+    StreamCompressor compressor(coding, level);
+    std::string out;
+    // Text series usually shrink several times over; a quarter is a cheap first guess
+    out.reserve(body.size() / 4 + 64);
+    compressor.write(body, out);
+    compressor.finish(out);
+    return out;
+}
+
+StreamCompressor::StreamCompressor(ContentCoding coding, int level) : stream(std::make_unique<z_stream>()) {
+    if (coding == ContentCoding::Identity) {
+        throw std::invalid_argument("StreamCompressor needs gzip or deflate");
+    }
+    int windowBits = coding == ContentCoding::Gzip ? GZIP_WINDOW_BITS : WINDOW_BITS;
+    if (deflateInit2(stream.get(), level, Z_DEFLATED, windowBits, MEMORY_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("Could not initialise zlib");
+    }
+}
+
+StreamCompressor::~StreamCompressor() {
+    deflateEnd(stream.get());
+}
+
+void StreamCompressor::deflateInto(std::string_view input, int flush, std::string& out) {
+    stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream->avail_in = static_cast<uInt>(input.size());
+    do {
+        size_t start = out.size();
+        size_t room = std::max(OUTPUT_STEP, static_cast<size_t>(deflateBound(stream.get(), stream->avail_in)));
+        out.resize(start + room);
+        stream->next_out = reinterpret_cast<Bytef*>(&out[start]);
+        stream->avail_out = static_cast<uInt>(room);
+        int status = deflate(stream.get(), flush);
+        out.resize(start + room - stream->avail_out);
+        if (status == Z_STREAM_ERROR) {
+            throw std::runtime_error("zlib deflate failed");
+        }
+        // A flush is complete once deflate returns with output space to spare
+    } while (stream->avail_out == 0 || stream->avail_in > 0);
+}
+
+void StreamCompressor::write(std::string_view input, std::string& out) {
+    if (input.empty()) return;
+    deflateInto(input, Z_SYNC_FLUSH, out);
+}
+
+void StreamCompressor::finish(std::string& out) {
+    deflateInto({}, Z_FINISH, out);
+}
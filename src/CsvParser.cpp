@@ -0,0 +1,134 @@
+#include "../include/CsvParser.h"
+#include "../include/DateTime.h"
+#include "../include/Metrics.h"
+#include <charconv>
+#include <cstring>
+
+namespace {
+    const char* const COLUMN_NAMES[StockCsvParser::FIELD_COUNT] = {
+        "Date", "Open", "High", "Low", "Close", "Volume"
+    };
+
+    std::string_view trim(std::string_view field) {
+        while (!field.empty() && (field.front() == ' ' || field.front() == '\t')) {
+            field.remove_prefix(1);
+        }
+        while (!field.empty() && (field.back() == ' ' || field.back() == '\t' || field.back() == '\r')) {
+            field.remove_suffix(1);
+        }
+        return field;
+    }
+
+    // Returns the line starting at pos and advances pos past its terminator
+    std::string_view nextLine(std::string_view content, size_t& pos) {
+        const char* begin = content.data() + pos;
+        const void* newline = std::memchr(begin, '\n', content.size() - pos);
+        size_t length = newline ? static_cast<const char*>(newline) - begin : content.size() - pos;
+        pos += newline ? length + 1 : length;
+
+        std::string_view line(begin, length);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        return line;
+    }
+}
+
+bool StockCsvParser::parseNumber(std::string_view field, double& value) {
+    field = trim(field);
+    if (!field.empty() && field.front() == '+') {
+        field.remove_prefix(1);
+    }
+    if (field.empty()) return false;
+
+    const char* end = field.data() + field.size();
+    auto result = std::from_chars(field.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+bool StockCsvParser::parseRow(std::string_view line, std::string_view& date, int64_t& timestamp,
+                              double (&values)[FIELD_COUNT - 1], std::string& error) {
+    size_t fieldIndex = 0;
+    size_t start = 0;
+
+    while (true) {
+        size_t comma = line.find(',', start);
+        std::string_view field = line.substr(start, comma == std::string_view::npos ? std::string_view::npos : comma - start);
+
+        if (fieldIndex >= FIELD_COUNT) {
+            error = "expected " + std::to_string(FIELD_COUNT) + " fields, found more";
+            return false;
+        }
+
+        if (fieldIndex == 0) {
+            date = trim(field);
+            if (date.empty()) {
+                error = "empty Date field";
+                return false;
+            }
+            if (!DateTime::parse(date, timestamp)) {
+                error = "invalid Date value '" + std::string(date) + "'";
+                return false;
+            }
+        } else if (!parseNumber(field, values[fieldIndex - 1])) {
+            error = "invalid " + std::string(COLUMN_NAMES[fieldIndex]) + " value '" + std::string(trim(field)) + "'";
+            return false;
+        }
+
+        ++fieldIndex;
+        if (comma == std::string_view::npos) break;
+        start = comma + 1;
+    }
+
+    if (fieldIndex != FIELD_COUNT) {
+        error = "expected " + std::to_string(FIELD_COUNT) + " fields, found " + std::to_string(fieldIndex);
+        return false;
+    }
+    return true;
+}
+
+PriceSeries StockCsvParser::parse(std::string_view content, const std::string& symbol,
+                                  std::vector<CsvParseError>* errors) {
+    Metrics::ScopedTimer timer(Metrics::Stage::CsvParse);
+    PriceSeries data(symbol);
+    size_t pos = 0;
+    size_t lineNumber = 1;
+
+    // Skip header
+    nextLine(content, pos);
+
+    // Rough row estimate so large files are not re-grown repeatedly
+    data.reserve(content.size() / 48);
+
+    std::string_view date;
+    int64_t timestamp = 0;
+    double values[FIELD_COUNT - 1];
+    std::string error;
+
+    while (pos < content.size()) {
+        std::string_view line = nextLine(content, pos);
+        ++lineNumber;
+
+        if (trim(line).empty()) continue;
+
+        if (!parseRow(line, date, timestamp, values, error)) {
+            if (errors) {
+                errors->push_back({lineNumber, error});
+            }
+            continue;
+        }
+        if (!data.empty() && timestamp <= data.getTimestamps().back()) {
+            if (errors) {
+                errors->push_back({lineNumber, "date " + std::string(date) + " is not after the previous row's date " +
+                                               std::string(data.getDate(data.size() - 1))});
+            }
+            continue;
+        }
+
+        data.append(date, timestamp, values[0], values[1], values[2], values[3], values[4]);
+    }
+
+    Metrics::add(Metrics::Counter::CsvRowsParsed, data.size());
+    Metrics::add(Metrics::Counter::CsvBytesParsed, content.size());
+    return data;
+}
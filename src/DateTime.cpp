@@ -0,0 +1,140 @@
+#include "../include/DateTime.h"
+#include <cstdio>
+
+namespace {
+    // Reads exactly `digits` decimal digits at pos
+    bool readNumber(std::string_view text, size_t& pos, size_t digits, unsigned& value) {
+        if (text.size() - pos < digits) return false;
+        value = 0;
+        for (size_t i = 0; i < digits; ++i) {
+            char c = text[pos + i];
+            if (c < '0' || c > '9') return false;
+            value = value * 10 + static_cast<unsigned>(c - '0');
+        }
+        pos += digits;
+        return true;
+    }
+
+    bool expect(std::string_view text, size_t& pos, char c) {
+        if (pos >= text.size() || text[pos] != c) return false;
+        ++pos;
+        return true;
+    }
+
+    unsigned daysInMonth(unsigned year, unsigned month) {
+        static const unsigned days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+        return month == 2 && leap ? 29 : days[month - 1];
+    }
+
+    // Components of a date or timestamp; the flags record which were present
+    struct Parsed {
+        unsigned year = 0, month = 1, day = 1, hour = 0, minute = 0, second = 0;
+        bool hasMonth = false, hasDay = false, hasMinute = false, hasSecond = false;
+    };
+
+    bool parseParts(std::string_view text, Parsed& parts) {
+        size_t pos = 0;
+        if (!readNumber(text, pos, 4, parts.year)) return false;
+        if (pos == text.size()) return true;
+
+        if (!expect(text, pos, '-') || !readNumber(text, pos, 2, parts.month)) return false;
+        if (parts.month < 1 || parts.month > 12) return false;
+        parts.hasMonth = true;
+        if (pos == text.size()) return true;
+
+        if (!expect(text, pos, '-') || !readNumber(text, pos, 2, parts.day)) return false;
+        if (parts.day < 1 || parts.day > daysInMonth(parts.year, parts.month)) return false;
+        parts.hasDay = true;
+        if (pos == text.size()) return true;
+
+        if (text[pos] != ' ' && text[pos] != 'T') return false;
+        ++pos;
+        if (!readNumber(text, pos, 2, parts.hour) || !expect(text, pos, ':') ||
+            !readNumber(text, pos, 2, parts.minute)) {
+            return false;
+        }
+        if (parts.hour > 23 || parts.minute > 59) return false;
+        parts.hasMinute = true;
+        if (pos < text.size() && text[pos] == ':') {
+            ++pos;
+            if (!readNumber(text, pos, 2, parts.second) || parts.second > 59) return false;
+            parts.hasSecond = true;
+        }
+        if (pos < text.size() && text[pos] == 'Z') ++pos;
+        return pos == text.size();
+    }
+
+    int64_t toEpochSeconds(const Parsed& parts) {
+        return DateTime::daysFromCivil(parts.year, parts.month, parts.day) * DateTime::SECONDS_PER_DAY +
+               parts.hour * 3600 + parts.minute * 60 + parts.second;
+    }
+}
+
+int64_t DateTime::daysFromCivil(int64_t year, unsigned month, unsigned day) {
+    // Howard Hinnant's days_from_civil: shift the year to start in March so
+    // the leap day falls at the end
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+}
+
+std::string DateTime::format(int64_t epochSeconds, bool includeTime) {
+    int64_t days = epochSeconds / SECONDS_PER_DAY;
+    int64_t seconds = epochSeconds % SECONDS_PER_DAY;
+    if (seconds < 0) {
+        seconds += SECONDS_PER_DAY;
+        --days;
+    }
+
+    // Inverse of daysFromCivil (civil_from_days)
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+    const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const unsigned shiftedMonth = (5 * dayOfYear + 2) / 153;
+    const unsigned day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    const unsigned month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    const int64_t year = static_cast<int64_t>(yearOfEra) + era * 400 + (month <= 2);
+
+    char buffer[48];
+    if (includeTime) {
+        std::snprintf(buffer, sizeof(buffer), "%04lld-%02u-%02u %02lld:%02lld:%02lld",
+                      static_cast<long long>(year), month, day, static_cast<long long>(seconds / 3600),
+                      static_cast<long long>(seconds / 60 % 60), static_cast<long long>(seconds % 60));
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%04lld-%02u-%02u", static_cast<long long>(year), month, day);
+    }
+    return buffer;
+}
+
+bool DateTime::parse(std::string_view text, int64_t& epochSeconds) {
+    Parsed parts;
+    if (!parseParts(text, parts) || !parts.hasDay) return false;
+    epochSeconds = toEpochSeconds(parts);
+    return true;
+}
+
+bool DateTime::parsePeriod(std::string_view text, int64_t& start, int64_t& end) {
+    Parsed parts;
+    if (!parseParts(text, parts)) return false;
+    start = toEpochSeconds(parts);
+
+    if (!parts.hasMonth) {
+        end = daysFromCivil(parts.year + 1, 1, 1) * SECONDS_PER_DAY;
+    } else if (!parts.hasDay) {
+        end = parts.month == 12 ? daysFromCivil(parts.year + 1, 1, 1) * SECONDS_PER_DAY
+                                : daysFromCivil(parts.year, parts.month + 1, 1) * SECONDS_PER_DAY;
+    } else if (!parts.hasMinute) {
+        end = start + SECONDS_PER_DAY;
+    } else if (!parts.hasSecond) {
+        end = start + 60;
+    } else {
+        end = start + 1;
+    }
+    return true;
+}
@@ -1,67 +1,199 @@
 #include "../include/FileHandler.h"
+#include "../include/CsvParser.h"
+#include "../include/DateTime.h"
+#include "../include/MappedFile.h"
+#include "../include/Metrics.h"
+#include "../include/Snapshot.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
 #include <fstream>
-#include <sstream>
 #include <stdexcept>
 #include <filesystem>
+#include <chrono>
 
 FileHandler::FileHandler(const std::string& directory) : dataDirectory(directory) {}
 
-std::vector<StockData> FileHandler::readStockData(const std::string& symbol) {
-    std::vector<StockData> data;
-    std::string filePath = buildFilePath(symbol);
-    std::ifstream file(filePath);
-    
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open file: " + filePath);
+namespace {
+    bool statFile(const std::string& filePath, FileVersion& version) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(filePath, ec);
+        if (ec) return false;
+        auto modified = std::filesystem::last_write_time(filePath, ec);
+        if (ec) return false;
+
+        version.modifiedTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            modified.time_since_epoch()).count();
+        version.size = size;
+        return true;
     }
 
-    std::string line;
-    // Skip header
-    std::getline(file, line);
-    
-    while (std::getline(file, line)) {
-        auto parts = splitCSVLine(line);
-        if (validateDataEntry(parts)) {
-            data.emplace_back(
-                symbol,
-                parts[0],  // date
-                std::stod(parts[1]),  // open
-                std::stod(parts[2]),  // high
-                std::stod(parts[3]),  // low
-                std::stod(parts[4]),  // close
-                std::stod(parts[5])   // volume
-            );
+    const char* const CSV_HEADER = "Date,Open,High,Low,Close,Volume\n";
+
+    // One CSV line per bar, in the column order of CSV_HEADER
+    void appendCsvRows(std::string& buffer, const PriceSeries& bars) {
+        const ColumnView<double> columns[] = {
+            bars.getOpens(), bars.getHighs(), bars.getLows(), bars.getCloses(), bars.getVolumes()
+        };
+        char number[32];
+        for (size_t row = 0; row < bars.size(); ++row) {
+            buffer += bars.getDate(row);
+            for (const auto& column : columns) {
+                auto result = std::to_chars(number, number + sizeof(number), column[row]);
+                buffer += ',';
+                buffer.append(number, result.ptr);
+            }
+            buffer += '\n';
+        }
+    }
+
+    // Each writer fills its own temporary file and renames it into place, so
+    // readers never see a partial file and concurrent writers never interleave
+    void replaceFile(const std::string& filePath, const std::string& buffer) {
+        static std::atomic<uint64_t> writeCounter{0};
+        std::string tempPath = filePath + ".tmp" + std::to_string(writeCounter.fetch_add(1));
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                throw std::runtime_error("Could not create file: " + filePath);
+            }
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            if (!file) {
+                std::error_code ec;
+                file.close();
+                std::filesystem::remove(tempPath, ec);
+                throw std::runtime_error("Could not write file: " + filePath);
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, filePath, ec);
+        if (ec) {
+            std::filesystem::remove(tempPath, ec);
+            throw std::runtime_error("Could not replace file: " + filePath);
         }
     }
+}
+
+PriceSeries FileHandler::readStockData(const std::string& symbol,
+                                      std::vector<CsvParseError>* errors) {
+    DataFile dataFile = resolveDataFile(symbol);
+    if (dataFile.isSnapshot) {
+        return Snapshot::load(dataFile.path);
+    }
 
-    return data;
+    MappedFile file(dataFile.path);
+    return StockCsvParser::parse(file.view(), symbol, errors);
 }
 
-void FileHandler::writePredictions(const std::string& symbol, const std::vector<double>& predictions) {
-    std::string filePath = buildFilePath(symbol, true);
-    std::ofstream file(filePath);
-    
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not create file: " + filePath);
+FileVersion FileHandler::getFileVersion(const std::string& symbol) {
+    return resolveDataFile(symbol).version;
+}
+
+std::vector<std::string> FileHandler::listSymbols() {
+    static const std::string PREDICTION_SUFFIX = "_predictions";
+    std::vector<std::string> symbols;
+    for (const auto& entry : std::filesystem::directory_iterator(dataDirectory)) {
+        if (!entry.is_regular_file()) continue;
+        std::string extension = entry.path().extension().string();
+        std::string stem = entry.path().stem().string();
+        if (extension != ".csv" && extension != Snapshot::FILE_EXTENSION) continue;
+        if (stem.size() >= PREDICTION_SUFFIX.size() &&
+            stem.compare(stem.size() - PREDICTION_SUFFIX.size(), std::string::npos, PREDICTION_SUFFIX) == 0) {
+            continue;
+        }
+        symbols.push_back(stem);
+    }
+    // A symbol with both a CSV and a snapshot is listed once
+    std::sort(symbols.begin(), symbols.end());
+    symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+    return symbols;
+}
+
+FileHandler::DataFile FileHandler::resolveDataFile(const std::string& symbol) {
+    DataFile csv{buildFilePath(symbol), false, {}};
+    DataFile snapshot{buildSnapshotPath(symbol), true, {}};
+
+    bool hasCsv = statFile(csv.path, csv.version);
+    bool hasSnapshot = statFile(snapshot.path, snapshot.version);
+
+    if (hasSnapshot && (!hasCsv || snapshot.version.modifiedTime >= csv.version.modifiedTime)) {
+        return snapshot;
+    }
+    if (!hasCsv) {
+        throw std::runtime_error("Could not open file: " + csv.path);
+    }
+    return csv;
+}
+
+void FileHandler::appendStockData(const std::string& symbol, const PriceSeries& bars) {
+    std::string filePath = buildFilePath(symbol);
+
+    // A symbol read from its snapshot has its history there, not in the CSV
+    // (which may be missing or older). Appending to the CSV would make it the
+    // newer file and hide that history, so the CSV is rewritten in full.
+    DataFile current = resolveDataFile(symbol);
+    if (current.isSnapshot) {
+        PriceSeries history = Snapshot::load(current.path);
+        std::string buffer = CSV_HEADER;
+        appendCsvRows(buffer, history);
+        appendCsvRows(buffer, bars);
+        replaceFile(filePath, buffer);
+
+        // Snapshots win mtime ties; make sure the rewritten CSV is read next
+        FileVersion written;
+        if (statFile(filePath, written) && written.modifiedTime <= current.version.modifiedTime) {
+            std::error_code ec;
+            std::filesystem::last_write_time(
+                filePath, std::filesystem::last_write_time(current.path, ec) + std::chrono::milliseconds(1), ec);
+        }
+        return;
+    }
+
+    // Make sure the first appended row starts on its own line
+    bool needsNewline = false;
+    {
+        std::ifstream existing(filePath, std::ios::binary | std::ios::ate);
+        if (existing.tellg() > 0) {
+            existing.seekg(-1, std::ios::end);
+            needsNewline = existing.get() != '\n';
+        }
     }
 
-    file << "Date,Predicted_Close\n";
-    // TODO: Add date generation logic
-    for (const auto& pred : predictions) {
-        file << "YYYY-MM-DD," << pred << "\n";
+    std::string buffer;
+    if (needsNewline) buffer += '\n';
+    appendCsvRows(buffer, bars);
+
+    std::ofstream file(filePath, std::ios::binary | std::ios::app);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filePath);
+    }
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!file) {
+        throw std::runtime_error("Could not write file: " + filePath);
     }
 }
 
-std::vector<std::string> FileHandler::splitCSVLine(const std::string& line) {
-    std::vector<std::string> result;
-    std::stringstream ss(line);
-    std::string item;
+void FileHandler::writePredictions(const std::string& symbol, const PriceSeries& data, size_t lookback,
+                                   const std::vector<double>& predictions) {
+    Metrics::ScopedTimer timer(Metrics::Stage::PredictionWrite);
+    if (lookback + predictions.size() > data.size()) {
+        throw std::invalid_argument("Predictions for " + symbol + " do not line up with its data");
+    }
+    std::string filePath = buildFilePath(symbol, true);
 
-    while (std::getline(ss, item, ',')) {
-        result.push_back(item);
+    std::string buffer = "Date,Predicted_Close\n";
+    buffer.reserve(buffer.size() + predictions.size() * 32);
+    char number[32];
+    for (size_t i = 0; i < predictions.size(); ++i) {
+        auto result = std::to_chars(number, number + sizeof(number), predictions[i]);
+        buffer += data.getDate(lookback + i);
+        buffer += ',';
+        buffer.append(number, result.ptr);
+        buffer += '\n';
     }
 
-    return result;
+    replaceFile(filePath, buffer);
 }
 
 bool FileHandler::validateCSVFormat(const std::string& filePath) {
@@ -81,17 +213,22 @@ bool FileHandler::validateCSVFormat(const std::string& filePath) {
 }
 
 bool FileHandler::validateDataEntry(const std::vector<std::string>& entry) {
-    if (entry.size() != 6) return false;
+    if (entry.size() != StockCsvParser::FIELD_COUNT) return false;
 
-    try {
-        // Skip date validation for now (entry[0])
-        for (size_t i = 1; i < entry.size(); ++i) {
-            std::stod(entry[i]);
-        }
-        return true;
-    } catch (...) {
-        return false;
+    int64_t timestamp;
+    if (!DateTime::parse(entry[0], timestamp)) return false;
+
+    double value;
+    for (size_t i = 1; i < entry.size(); ++i) {
+        if (!StockCsvParser::parseNumber(entry[i], value)) return false;
     }
+    return true;
+}
+
+std::string FileHandler::buildSnapshotPath(const std::string& symbol) {
+    std::filesystem::path path(dataDirectory);
+    path /= (symbol + Snapshot::FILE_EXTENSION);
+    return path.string();
 }
 
 std::string FileHandler::buildFilePath(const std::string& symbol, bool isPrediction) {
@@ -0,0 +1,581 @@
+#include "../include/Indicators.h"
+#include "../include/RequestArena.h"
+#include "../include/SeriesKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    // Bars after which history weighted by (1 - alpha)^k falls below 1e-12,
+    // the same cut-off the EMA algorithm uses for its warm-up
+    size_t decayBars(double alpha) {
+        if (alpha >= 1.0) return 0;
+        return static_cast<size_t>(std::ceil(std::log(1e-12) / std::log(1.0 - alpha)));
+    }
+
+    void checkRange(const char* name, double value, double min, double max) {
+        if (value < min || value > max) {
+            std::stringstream ss;
+            ss << name << " must be between " << min << " and " << max;
+            throw std::invalid_argument(ss.str());
+        }
+    }
+
+    // Weighted sum updated in O(1): moving one bar on, every bar in the
+    // window loses one unit of weight (the oldest drops out) and the new bar
+    // enters with the full window weight
+    class WeightedMovingAverageKernel : public IndicatorKernel {
+    private:
+        size_t window;
+        double scale;  // 1 / sum of the weights
+        double sum = 0.0;
+        double weighted = 0.0;
+        size_t sinceResum = 0;
+
+    public:
+        explicit WeightedMovingAverageKernel(size_t windowSize)
+            : window(windowSize), scale(2.0 / static_cast<double>(windowSize * (windowSize + 1))) {}
+
+        void process(const IndicatorBlock& block, double* out) override {
+            const double* closes = block.closes;
+            const double newest = static_cast<double>(window);
+            for (size_t t = std::max(block.begin, window - 1); t < block.end; ++t) {
+                if (t == window - 1 || sinceResum == SeriesKernels::RESUM_INTERVAL) {
+                    // First window, and periodically after it so rounding cannot build up
+                    sum = weighted = 0.0;
+                    for (size_t j = 0; j < window; ++j) {
+                        double close = closes[t + 1 - window + j];
+                        sum += close;
+                        weighted += static_cast<double>(j + 1) * close;
+                    }
+                    sinceResum = 0;
+                } else {
+                    weighted += newest * closes[t] - sum;
+                    sum += closes[t] - closes[t - window];
+                }
+                ++sinceResum;
+                out[t + 1 - window] = weighted * scale;
+            }
+        }
+    };
+
+    // Per-block scratch; taken from the request's arena when there is one
+    std::pmr::vector<double> blockBuffer(size_t size = IndicatorEngine::BLOCK_BARS) {
+        return std::pmr::vector<double>(size, RequestArena::current());
+    }
+
+    // Rolling sums of the closes and their squares, taken relative to a
+    // recent close so the variance does not cancel away; the bands are then
+    // formed for the whole block at once
+    class BollingerBandsKernel : public IndicatorKernel {
+    private:
+        size_t window;
+        double width;
+        double shift = 0.0;
+        double sum = 0.0;
+        double squares = 0.0;
+        size_t sinceResum = 0;
+        std::pmr::vector<double> means;
+        std::pmr::vector<double> variances;
+
+    public:
+        BollingerBandsKernel(size_t windowSize, double bandWidth)
+            : window(windowSize), width(bandWidth),
+              means(blockBuffer()), variances(blockBuffer()) {}
+
+        void process(const IndicatorBlock& block, double* out) override {
+            const double* closes = block.closes;
+            const double divisor = static_cast<double>(window);
+            size_t first = std::max(block.begin, window - 1);
+            for (size_t t = first; t < block.end; ++t) {
+                if (t == window - 1 || sinceResum == SeriesKernels::RESUM_INTERVAL) {
+                    shift = closes[t + 1 - window];
+                    sum = squares = 0.0;
+                    for (size_t j = t + 1 - window; j <= t; ++j) {
+                        double deviation = closes[j] - shift;
+                        sum += deviation;
+                        squares += deviation * deviation;
+                    }
+                    sinceResum = 0;
+                } else {
+                    double entering = closes[t] - shift;
+                    double leaving = closes[t - window] - shift;
+                    sum += entering - leaving;
+                    squares += entering * entering - leaving * leaving;
+                }
+                ++sinceResum;
+                double mean = sum / divisor;
+                means[t - first] = shift + mean;
+                variances[t - first] = squares / divisor - mean * mean;
+            }
+            if (first < block.end) {
+                SeriesKernels::bands(means.data(), variances.data(), block.end - first, width, out + first + 1 - window);
+            }
+        }
+    };
+
+    // Powers of decay for SeriesKernels::linearRecurrence over up to one block
+    std::pmr::vector<double> blockPowers(double decay) {
+        auto powers = blockBuffer(IndicatorEngine::BLOCK_BARS / 4 + 1);
+        SeriesKernels::decayPowers(decay, powers.size(), powers.data());
+        return powers;
+    }
+
+    // Wilder smoothing of the shared gain/loss columns; the first average is
+    // the plain mean of the first period changes. Wilder's update,
+    // average * (period - 1) / period + value / period, is a linear
+    // recurrence, so the rest of each block goes to the vector kernel.
+    class RelativeStrengthIndexKernel : public IndicatorKernel {
+    private:
+        size_t period;
+        double keep;
+        double scale;
+        double averageGain = 0.0;
+        double averageLoss = 0.0;
+        std::pmr::vector<double> powers;
+        std::pmr::vector<double> gains;
+        std::pmr::vector<double> losses;
+
+    public:
+        explicit RelativeStrengthIndexKernel(size_t periods)
+            : period(periods), keep(1.0 - 1.0 / static_cast<double>(periods)),
+              scale(1.0 / static_cast<double>(periods)), powers(blockPowers(keep)),
+              gains(blockBuffer()), losses(blockBuffer()) {}
+
+        void process(const IndicatorBlock& block, double* out) override {
+            size_t first = std::max(block.begin, period);
+            size_t t = block.begin;
+            for (; t < block.end && t <= period; ++t) {
+                averageGain += block.gains[t - block.begin];
+                averageLoss += block.losses[t - block.begin];
+                if (t == period) {
+                    averageGain /= static_cast<double>(period);
+                    averageLoss /= static_cast<double>(period);
+                    gains[0] = averageGain;
+                    losses[0] = averageLoss;
+                }
+            }
+            if (t < block.end) {
+                SeriesKernels::linearRecurrence(block.gains + (t - block.begin), block.end - t, keep, scale,
+                                                powers.data(), averageGain, gains.data() + (t - first));
+                SeriesKernels::linearRecurrence(block.losses + (t - block.begin), block.end - t, keep, scale,
+                                                powers.data(), averageLoss, losses.data() + (t - first));
+            }
+            if (first < block.end) {
+                SeriesKernels::relativeStrength(gains.data(), losses.data(), block.end - first, out + first - period);
+            }
+        }
+    };
+
+    // Three EMAs, each a linear recurrence over a whole block: fast and slow
+    // over the closes, then the signal over their difference
+    class MacdKernel : public IndicatorKernel {
+    public:
+        enum class Line { Macd, Signal, Histogram };
+
+    private:
+        double fastAlpha;
+        double slowAlpha;
+        double signalAlpha;
+        Line line;
+        double fast = 0.0;
+        double slow = 0.0;
+        double signal = 0.0;
+        std::pmr::vector<double> fastPowers;
+        std::pmr::vector<double> slowPowers;
+        std::pmr::vector<double> signalPowers;
+        std::pmr::vector<double> macdLine;
+        std::pmr::vector<double> scratch;
+
+    public:
+        MacdKernel(int fastPeriod, int slowPeriod, int signalPeriod, Line output)
+            : fastAlpha(2.0 / (fastPeriod + 1)), slowAlpha(2.0 / (slowPeriod + 1)),
+              signalAlpha(2.0 / (signalPeriod + 1)), line(output),
+              fastPowers(blockPowers(1 - fastAlpha)), slowPowers(blockPowers(1 - slowAlpha)),
+              signalPowers(blockPowers(1 - signalAlpha)),
+              macdLine(blockBuffer()), scratch(blockBuffer()) {}
+
+        void process(const IndicatorBlock& block, double* out) override {
+            size_t t = block.begin;
+            if (t == 0) {
+                // Seeded with the first close: every line starts at 0
+                fast = slow = block.closes[0];
+                signal = 0.0;
+                out[0] = 0.0;
+                t = 1;
+            }
+            if (t >= block.end) return;
+
+            size_t count = block.end - t;
+            SeriesKernels::linearRecurrence(block.closes + t, count, 1 - fastAlpha, fastAlpha, fastPowers.data(),
+                                            fast, macdLine.data());
+            SeriesKernels::linearRecurrence(block.closes + t, count, 1 - slowAlpha, slowAlpha, slowPowers.data(),
+                                            slow, scratch.data());
+            for (size_t i = 0; i < count; ++i) {
+                macdLine[i] -= scratch[i];
+            }
+            if (line == Line::Macd) {
+                std::copy(macdLine.begin(), macdLine.begin() + count, out + t);
+                return;
+            }
+
+            double* signalLine = line == Line::Signal ? out + t : scratch.data();
+            SeriesKernels::linearRecurrence(macdLine.data(), count, 1 - signalAlpha, signalAlpha,
+                                            signalPowers.data(), signal, signalLine);
+            if (line == Line::Histogram) {
+                for (size_t i = 0; i < count; ++i) {
+                    out[t + i] = macdLine[i] - scratch[i];
+                }
+            }
+        }
+    };
+
+    // Wilder smoothing of the shared true-range column, as in RSI
+    class AverageTrueRangeKernel : public IndicatorKernel {
+    private:
+        size_t period;
+        double keep;
+        double scale;
+        double average = 0.0;
+        std::pmr::vector<double> powers;
+
+    public:
+        explicit AverageTrueRangeKernel(size_t periods)
+            : period(periods), keep(1.0 - 1.0 / static_cast<double>(periods)),
+              scale(1.0 / static_cast<double>(periods)), powers(blockPowers(keep)) {}
+
+        void process(const IndicatorBlock& block, double* out) override {
+            size_t t = block.begin;
+            for (; t < block.end && t < period; ++t) {
+                average += block.trueRanges[t - block.begin];
+                if (t + 1 == period) {
+                    average /= static_cast<double>(period);
+                    out[0] = average;
+                }
+            }
+            if (t < block.end) {
+                SeriesKernels::linearRecurrence(block.trueRanges + (t - block.begin), block.end - t, keep, scale,
+                                                powers.data(), average, out + (t + 1 - period));
+            }
+        }
+    };
+}
+
+// Indicator
+std::vector<double> Indicator::predict(const PriceSeries& data) const {
+    std::vector<double> predictions;
+    predictInto(data, predictions);
+    return predictions;
+}
+
+void Indicator::predictInto(const PriceSeries& data, std::vector<double>& out) const {
+    IndicatorEngine::run(data, {this}, {&out});
+}
+
+void Indicator::checkLength(const PriceSeries& data) const {
+    if (data.size() <= getLookback()) {
+        throw std::runtime_error("Insufficient data points for " + getName() + ": needs at least " +
+                                 std::to_string(getLookback() + 1) + " bars");
+    }
+}
+
+// IndicatorEngine
+void IndicatorEngine::run(const PriceSeries& data, const std::vector<const Indicator*>& indicators,
+                          const std::vector<std::vector<double>*>& outputs) {
+    if (indicators.size() != outputs.size()) {
+        throw std::invalid_argument("Every indicator needs exactly one output");
+    }
+
+    unsigned inputs = 0;
+    std::vector<std::unique_ptr<IndicatorKernel>> kernels;
+    kernels.reserve(indicators.size());
+    for (const Indicator* indicator : indicators) {
+        indicator->checkLength(data);
+        inputs |= indicator->getInputs();
+    }
+    for (size_t i = 0; i < indicators.size(); ++i) {
+        outputs[i]->resize(data.size() - indicators[i]->getLookback());
+        kernels.push_back(indicators[i]->createKernel());
+    }
+
+    auto closes = data.getCloses();
+    auto highs = data.getHighs();
+    auto lows = data.getLows();
+    IndicatorBlock block;
+    block.closes = closes.data();
+    block.highs = highs.data();
+    block.lows = lows.data();
+
+    std::pmr::vector<double> gains(RequestArena::current());
+    std::pmr::vector<double> losses(RequestArena::current());
+    std::pmr::vector<double> trueRanges(RequestArena::current());
+    if (inputs & Indicator::PRICE_CHANGES) {
+        gains.resize(BLOCK_BARS);
+        losses.resize(BLOCK_BARS);
+        block.gains = gains.data();
+        block.losses = losses.data();
+    }
+    if (inputs & Indicator::TRUE_RANGES) {
+        trueRanges.resize(BLOCK_BARS);
+        block.trueRanges = trueRanges.data();
+    }
+
+    for (size_t begin = 0; begin < data.size(); begin += BLOCK_BARS) {
+        block.begin = begin;
+        block.end = std::min(data.size(), begin + BLOCK_BARS);
+
+        // Bar 0 has no previous close
+        size_t skip = begin == 0 ? 1 : 0;
+        size_t count = block.end - begin - skip;
+        if (inputs & Indicator::PRICE_CHANGES) {
+            if (skip) gains[0] = losses[0] = 0.0;
+            SeriesKernels::priceChanges(block.closes + begin + skip - 1, count, gains.data() + skip,
+                                        losses.data() + skip);
+        }
+        if (inputs & Indicator::TRUE_RANGES) {
+            if (skip) trueRanges[0] = block.highs[0] - block.lows[0];
+            SeriesKernels::trueRanges(block.highs + begin + skip, block.lows + begin + skip,
+                                      block.closes + begin + skip - 1, count, trueRanges.data() + skip);
+        }
+
+        for (size_t i = 0; i < kernels.size(); ++i) {
+            kernels[i]->process(block, outputs[i]->data());
+        }
+    }
+}
+
+// Weighted Moving Average Implementation
+WeightedMovingAverageAlgorithm::WeightedMovingAverageAlgorithm(int window) : windowSize(window) {
+    validate();
+}
+
+void WeightedMovingAverageAlgorithm::configure(const nlohmann::json& params) {
+    if (params.contains("window_size")) {
+        windowSize = params["window_size"].get<int>();
+    }
+    validate();
+}
+
+nlohmann::json WeightedMovingAverageAlgorithm::getParameters() const {
+    return {
+        {"window_size", windowSize},
+        {"min_window", MIN_WINDOW},
+        {"max_window", MAX_WINDOW}
+    };
+}
+
+void WeightedMovingAverageAlgorithm::validate() const {
+    checkRange("Window size", windowSize, MIN_WINDOW, MAX_WINDOW);
+}
+
+std::unique_ptr<IndicatorKernel> WeightedMovingAverageAlgorithm::createKernel() const {
+    return std::make_unique<WeightedMovingAverageKernel>(static_cast<size_t>(windowSize));
+}
+
+std::unique_ptr<PredictionAlgorithm> WeightedMovingAverageAlgorithm::clone() const {
+    return std::make_unique<WeightedMovingAverageAlgorithm>(*this);
+}
+
+std::string WeightedMovingAverageAlgorithm::getDescription() const {
+    return "Weighted Moving Average (WMA) using " + std::to_string(windowSize) + " day window";
+}
+
+// Bollinger Bands Implementation
+BollingerBandsAlgorithm::BollingerBandsAlgorithm(int window, double deviations, const std::string& line)
+    : windowSize(window), numStd(deviations), band(line) {
+    validate();
+}
+
+void BollingerBandsAlgorithm::configure(const nlohmann::json& params) {
+    if (params.contains("window_size")) {
+        windowSize = params["window_size"].get<int>();
+    }
+    if (params.contains("num_std")) {
+        numStd = params["num_std"].get<double>();
+    }
+    if (params.contains("band")) {
+        band = params["band"].get<std::string>();
+    }
+    validate();
+}
+
+nlohmann::json BollingerBandsAlgorithm::getParameters() const {
+    return {
+        {"window_size", windowSize},
+        {"num_std", numStd},
+        {"band", band},
+        {"min_window", MIN_WINDOW},
+        {"max_window", MAX_WINDOW}
+    };
+}
+
+void BollingerBandsAlgorithm::validate() const {
+    checkRange("Window size", windowSize, MIN_WINDOW, MAX_WINDOW);
+    checkRange("num_std", numStd, MIN_STD, MAX_STD);
+    if (band != "upper" && band != "middle" && band != "lower") {
+        throw std::invalid_argument("band must be \"upper\", \"middle\" or \"lower\"");
+    }
+}
+
+std::unique_ptr<IndicatorKernel> BollingerBandsAlgorithm::createKernel() const {
+    double width = band == "upper" ? numStd : band == "lower" ? -numStd : 0.0;
+    return std::make_unique<BollingerBandsKernel>(static_cast<size_t>(windowSize), width);
+}
+
+std::unique_ptr<PredictionAlgorithm> BollingerBandsAlgorithm::clone() const {
+    return std::make_unique<BollingerBandsAlgorithm>(*this);
+}
+
+std::string BollingerBandsAlgorithm::getDescription() const {
+    std::stringstream ss;
+    ss << "Bollinger Bands (" << band << " band) over a " << windowSize << " day window, " << numStd
+       << " standard deviations wide";
+    return ss.str();
+}
+
+// Relative Strength Index Implementation
+RelativeStrengthIndexAlgorithm::RelativeStrengthIndexAlgorithm(int periods) : period(periods) {
+    validate();
+}
+
+void RelativeStrengthIndexAlgorithm::configure(const nlohmann::json& params) {
+    if (params.contains("period")) {
+        period = params["period"].get<int>();
+    }
+    validate();
+}
+
+nlohmann::json RelativeStrengthIndexAlgorithm::getParameters() const {
+    return {
+        {"period", period},
+        {"min_period", MIN_PERIOD},
+        {"max_period", MAX_PERIOD}
+    };
+}
+
+void RelativeStrengthIndexAlgorithm::validate() const {
+    checkRange("Period", period, MIN_PERIOD, MAX_PERIOD);
+}
+
+size_t RelativeStrengthIndexAlgorithm::getWarmup() const {
+    return getLookback() + decayBars(1.0 / period);
+}
+
+std::unique_ptr<IndicatorKernel> RelativeStrengthIndexAlgorithm::createKernel() const {
+    return std::make_unique<RelativeStrengthIndexKernel>(static_cast<size_t>(period));
+}
+
+std::unique_ptr<PredictionAlgorithm> RelativeStrengthIndexAlgorithm::clone() const {
+    return std::make_unique<RelativeStrengthIndexAlgorithm>(*this);
+}
+
+std::string RelativeStrengthIndexAlgorithm::getDescription() const {
+    return "Relative Strength Index (RSI) over " + std::to_string(period) + " days";
+}
+
+// MACD Implementation
+MacdAlgorithm::MacdAlgorithm(int fast, int slow, int signal, const std::string& line)
+    : fastPeriod(fast), slowPeriod(slow), signalPeriod(signal), output(line) {
+    validate();
+}
+
+void MacdAlgorithm::configure(const nlohmann::json& params) {
+    if (params.contains("fast_period")) {
+        fastPeriod = params["fast_period"].get<int>();
+    }
+    if (params.contains("slow_period")) {
+        slowPeriod = params["slow_period"].get<int>();
+    }
+    if (params.contains("signal_period")) {
+        signalPeriod = params["signal_period"].get<int>();
+    }
+    if (params.contains("output")) {
+        output = params["output"].get<std::string>();
+    }
+    validate();
+}
+
+nlohmann::json MacdAlgorithm::getParameters() const {
+    return {
+        {"fast_period", fastPeriod},
+        {"slow_period", slowPeriod},
+        {"signal_period", signalPeriod},
+        {"output", output},
+        {"min_period", MIN_PERIOD},
+        {"max_period", MAX_PERIOD}
+    };
+}
+
+void MacdAlgorithm::validate() const {
+    checkRange("fast_period", fastPeriod, MIN_PERIOD, MAX_PERIOD);
+    checkRange("slow_period", slowPeriod, MIN_PERIOD, MAX_PERIOD);
+    checkRange("signal_period", signalPeriod, MIN_PERIOD, MAX_PERIOD);
+    if (fastPeriod >= slowPeriod) {
+        throw std::invalid_argument("fast_period must be shorter than slow_period");
+    }
+    if (output != "macd" && output != "signal" && output != "histogram") {
+        throw std::invalid_argument("output must be \"macd\", \"signal\" or \"histogram\"");
+    }
+}
+
+size_t MacdAlgorithm::getWarmup() const {
+    // The slow average has the longest memory; the signal adds its own on top
+    return decayBars(2.0 / (slowPeriod + 1)) + decayBars(2.0 / (signalPeriod + 1));
+}
+
+std::unique_ptr<IndicatorKernel> MacdAlgorithm::createKernel() const {
+    auto line = output == "macd" ? MacdKernel::Line::Macd
+              : output == "signal" ? MacdKernel::Line::Signal
+              : MacdKernel::Line::Histogram;
+    return std::make_unique<MacdKernel>(fastPeriod, slowPeriod, signalPeriod, line);
+}
+
+std::unique_ptr<PredictionAlgorithm> MacdAlgorithm::clone() const {
+    return std::make_unique<MacdAlgorithm>(*this);
+}
+
+std::string MacdAlgorithm::getDescription() const {
+    return "MACD (" + output + ") with " + std::to_string(fastPeriod) + "/" + std::to_string(slowPeriod) +
+           " day EMAs and a " + std::to_string(signalPeriod) + " day signal";
+}
+
+// Average True Range Implementation
+AverageTrueRangeAlgorithm::AverageTrueRangeAlgorithm(int periods) : period(periods) {
+    validate();
+}
+
+void AverageTrueRangeAlgorithm::configure(const nlohmann::json& params) {
+    if (params.contains("period")) {
+        period = params["period"].get<int>();
+    }
+    validate();
+}
+
+nlohmann::json AverageTrueRangeAlgorithm::getParameters() const {
+    return {
+        {"period", period},
+        {"min_period", MIN_PERIOD},
+        {"max_period", MAX_PERIOD}
+    };
+}
+
+void AverageTrueRangeAlgorithm::validate() const {
+    checkRange("Period", period, MIN_PERIOD, MAX_PERIOD);
+}
+
+size_t AverageTrueRangeAlgorithm::getWarmup() const {
+    return getLookback() + decayBars(1.0 / period);
+}
+
+std::unique_ptr<IndicatorKernel> AverageTrueRangeAlgorithm::createKernel() const {
+    return std::make_unique<AverageTrueRangeKernel>(static_cast<size_t>(period));
+}
+
+std::unique_ptr<PredictionAlgorithm> AverageTrueRangeAlgorithm::clone() const {
+    return std::make_unique<AverageTrueRangeAlgorithm>(*this);
+}
+
+std::string AverageTrueRangeAlgorithm::getDescription() const {
+    return "Average True Range (ATR) over " + std::to_string(period) + " days";
+}
@@ -0,0 +1,125 @@
+#include "../include/JsonWriter.h"
+#include <charconv>
+#include <cmath>
+
+JsonWriter::JsonWriter(size_t reserveBytes, std::pmr::memory_resource* resource)
+    : buffer(resource), hasValue(resource) {
+    buffer.reserve(reserveBytes);
+}
+
+void JsonWriter::separate() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (!hasValue.empty()) {
+        if (hasValue.back()) buffer += ',';
+        hasValue.back() = true;
+    }
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    buffer += '{';
+    hasValue.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    buffer += '}';
+    hasValue.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    buffer += '[';
+    hasValue.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    buffer += ']';
+    hasValue.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    value(name);
+    buffer += ':';
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double number) {
+    if (!std::isfinite(number)) return null();
+    separate();
+    char text[32];
+    auto result = std::to_chars(text, text + sizeof(text), number);
+    buffer.append(text, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(int64_t number) {
+    separate();
+    char text[24];
+    auto result = std::to_chars(text, text + sizeof(text), number);
+    buffer.append(text, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(uint64_t number) {
+    separate();
+    char text[24];
+    auto result = std::to_chars(text, text + sizeof(text), number);
+    buffer.append(text, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separate();
+    buffer += flag ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view text) {
+    separate();
+    static const char hex[] = "0123456789abcdef";
+    buffer += '"';
+    size_t plain = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        buffer.append(text.data() + plain, i - plain);
+        plain = i + 1;
+        switch (c) {
+            case '"': buffer += "\\\""; break;
+            case '\\': buffer += "\\\\"; break;
+            case '\n': buffer += "\\n"; break;
+            case '\r': buffer += "\\r"; break;
+            case '\t': buffer += "\\t"; break;
+            case '\b': buffer += "\\b"; break;
+            case '\f': buffer += "\\f"; break;
+            default:
+                buffer += "\\u00";
+                buffer += hex[c >> 4];
+                buffer += hex[c & 0xF];
+        }
+    }
+    buffer.append(text.data() + plain, text.size() - plain);
+    buffer += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    buffer += "null";
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(std::string_view json) {
+    separate();
+    buffer += json;
+    return *this;
+}
@@ -0,0 +1,45 @@
+#include "../include/Log.h"
+#include "../include/DateTime.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+
+namespace {
+    std::atomic<int> runtimeLevel{static_cast<int>(LogLevel::Info)};
+    std::mutex writeMutex;
+
+    const char* const LEVEL_NAMES[] = {"error", "warn", "info", "debug"};
+}
+
+bool Log::enabled(LogLevel level) {
+    return static_cast<int>(level) <= runtimeLevel.load(std::memory_order_relaxed);
+}
+
+void Log::setLevel(LogLevel level) {
+    runtimeLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+LogLevel Log::getLevel() {
+    return static_cast<LogLevel>(runtimeLevel.load(std::memory_order_relaxed));
+}
+
+bool Log::parseLevel(std::string_view text, LogLevel& level) {
+    for (int i = 0; i <= static_cast<int>(LogLevel::Debug); ++i) {
+        if (text == LEVEL_NAMES[i]) {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Log::write(LogLevel level, const std::string& message) {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+    std::string timestamp = DateTime::format(millis / 1000, true);
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::fprintf(stderr, "%s.%03d [%s] %s\n", timestamp.c_str(), static_cast<int>(millis % 1000),
+                 LEVEL_NAMES[static_cast<int>(level)], message.c_str());
+}
@@ -0,0 +1,71 @@
+#include "../include/MappedFile.h"
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <fstream>
+#include <sstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filePath);
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    fallbackBuffer = contents.str();
+    mappedData = fallbackBuffer.data();
+    mappedSize = fallbackBuffer.size();
+}
+
+MappedFile::~MappedFile() = default;
+
+#else
+
+MappedFile::MappedFile(const std::string& filePath) {
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + filePath);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not stat file: " + filePath);
+    }
+
+    mappedSize = static_cast<size_t>(info.st_size);
+    if (mappedSize == 0) {
+        // mmap rejects zero-length mappings; an empty view is all we need
+        ::close(fd);
+        mappedData = fallbackBuffer.data();
+        return;
+    }
+
+    void* address = ::mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        throw std::runtime_error("Could not map file: " + filePath);
+    }
+
+    // The parser walks the file front to back exactly once
+    ::madvise(address, mappedSize, MADV_SEQUENTIAL);
+
+    mappedData = static_cast<const char*>(address);
+    isMapped = true;
+}
+
+MappedFile::~MappedFile() {
+    if (isMapped) {
+        ::munmap(const_cast<char*>(mappedData), mappedSize);
+    }
+}
+
+#endif
@@ -0,0 +1,349 @@
+#include "../include/Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+    int exponent = 63 - __builtin_clzll(value);
+    if (exponent > MAX_EXPONENT) return BUCKET_COUNT - 1;
+    uint64_t sub = (value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return static_cast<size_t>(SUB_BUCKETS + static_cast<uint64_t>(exponent - SUB_BUCKET_BITS) * SUB_BUCKETS + sub);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < SUB_BUCKETS) return index;
+    size_t offset = index - SUB_BUCKETS;
+    int shift = static_cast<int>(offset / SUB_BUCKETS);
+    uint64_t lower = (SUB_BUCKETS + offset % SUB_BUCKETS) << shift;
+    return lower + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::add(size_t bucket, uint64_t bucketCount, uint64_t bucketSum) {
+    buckets[bucket] += bucketCount;
+    count += bucketCount;
+    sum += bucketSum;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sum += other.sum;
+}
+
+uint64_t LatencyHistogram::countAtOrBelow(uint64_t value) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < BUCKET_COUNT && bucketUpperBound(i) <= value; ++i) {
+        total += buckets[i];
+    }
+    return total;
+}
+
+uint64_t LatencyHistogram::quantile(double q) const {
+    if (count == 0) return 0;
+    q = std::min(std::max(q, 0.0), 1.0);
+    // Rank of the value at q, 1-based, so q = 0 finds the minimum bucket
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * static_cast<double>(count) + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) return bucketUpperBound(i);
+    }
+    return bucketUpperBound(BUCKET_COUNT - 1);
+}
+
+namespace {
+    constexpr size_t ROUTE_COUNT = static_cast<size_t>(Metrics::Route::Count);
+    constexpr size_t STAGE_COUNT = static_cast<size_t>(Metrics::Stage::Count);
+    constexpr size_t COUNTER_COUNT = static_cast<size_t>(Metrics::Counter::Count);
+
+    // Exported histogram bounds are powers of two nanoseconds, which are
+    // bucket boundaries, so the cumulative counts are exact: 2^10 ns (about
+    // 1 us) up to 2^35 ns (about 34 s)
+    constexpr int EXPORT_MIN_EXPONENT = 10;
+    constexpr int EXPORT_MAX_EXPONENT = 35;
+
+    struct RouteInfo {
+        const char* method;
+        const char* path;
+    };
+
+    const RouteInfo ROUTES[ROUTE_COUNT] = {
+        {"GET", "/"},
+        {"GET", "/api/stocks/{symbol}"},
+        {"POST", "/api/stocks/{symbol}/bars"},
+        {"POST", "/api/predict"},
+        {"POST", "/api/predict/batch"},
+        {"POST", "/api/backtest"},
+        {"POST", "/api/sweep"},
+        {"POST", "/api/analyze"},
+        {"GET", "/api/algorithms"},
+        {"GET", "/api/cache/stats"},
+        {"GET", "/metrics"},
+        {"GET", "/ready"},
+        {"GET", "/api/symbols"},
+        {"POST", "/api/test"},
+        {"OPTIONS", "*"}
+    };
+
+    const char* const STAGES[STAGE_COUNT] = {
+        "csv_parse",
+        "snapshot_load",
+        "algorithm_compute",
+        "json_serialize",
+        "prediction_write",
+        "compress"
+    };
+
+    // Only the owning thread writes a shard, so a relaxed load + store
+    // replaces the locked read-modify-write of fetch_add
+    inline void bump(std::atomic<uint64_t>& value, uint64_t amount) {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    struct ShardHistogram {
+        std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKET_COUNT> buckets{};
+        std::atomic<uint64_t> sum{0};
+
+        void record(uint64_t value) {
+            bump(buckets[LatencyHistogram::bucketIndex(value)], 1);
+            bump(sum, value);
+        }
+
+        void addTo(LatencyHistogram& total) const {
+            uint64_t bucketSum = sum.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+                uint64_t n = buckets[i].load(std::memory_order_relaxed);
+                if (n == 0) continue;
+                total.add(i, n, bucketSum);
+                bucketSum = 0;  // the sum is added once, with the first non-empty bucket
+            }
+        }
+    };
+
+    struct RouteStats {
+        ShardHistogram latency;
+        std::atomic<uint64_t> bytesIn{0};
+        std::atomic<uint64_t> bytesOut{0};
+        std::atomic<uint64_t> failures{0};
+    };
+
+    struct Shard {
+        std::array<RouteStats, ROUTE_COUNT> routes;
+        std::array<ShardHistogram, STAGE_COUNT> stages;
+        std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters{};
+    };
+
+    // Plain totals, summed from every shard at scrape time
+    struct Totals {
+        std::array<LatencyHistogram, ROUTE_COUNT> latency;
+        std::array<uint64_t, ROUTE_COUNT> bytesIn{};
+        std::array<uint64_t, ROUTE_COUNT> bytesOut{};
+        std::array<uint64_t, ROUTE_COUNT> failures{};
+        std::array<LatencyHistogram, STAGE_COUNT> stages;
+        std::array<uint64_t, COUNTER_COUNT> counters{};
+
+        void add(const Shard& shard) {
+            for (size_t r = 0; r < ROUTE_COUNT; ++r) {
+                shard.routes[r].latency.addTo(latency[r]);
+                bytesIn[r] += shard.routes[r].bytesIn.load(std::memory_order_relaxed);
+                bytesOut[r] += shard.routes[r].bytesOut.load(std::memory_order_relaxed);
+                failures[r] += shard.routes[r].failures.load(std::memory_order_relaxed);
+            }
+            for (size_t s = 0; s < STAGE_COUNT; ++s) {
+                shard.stages[s].addTo(stages[s]);
+            }
+            for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+                counters[c] += shard.counters[c].load(std::memory_order_relaxed);
+            }
+        }
+
+        void merge(const Totals& other) {
+            for (size_t r = 0; r < ROUTE_COUNT; ++r) {
+                latency[r].merge(other.latency[r]);
+                bytesIn[r] += other.bytesIn[r];
+                bytesOut[r] += other.bytesOut[r];
+                failures[r] += other.failures[r];
+            }
+            for (size_t s = 0; s < STAGE_COUNT; ++s) {
+                stages[s].merge(other.stages[s]);
+            }
+            for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+                counters[c] += other.counters[c];
+            }
+        }
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<Shard*> shards;
+        Totals retired;  // shards of threads that have exited
+    };
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    // Registers the calling thread's shard on first use and folds it into
+    // the retired totals when the thread exits
+    class ShardHandle {
+    private:
+        Shard* shard;
+
+    public:
+        ShardHandle() : shard(new Shard()) {
+            Registry& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.shards.push_back(shard);
+        }
+
+        ~ShardHandle() {
+            Registry& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.retired.add(*shard);
+            reg.shards.erase(std::find(reg.shards.begin(), reg.shards.end(), shard));
+            delete shard;
+        }
+
+        ShardHandle(const ShardHandle&) = delete;
+        ShardHandle& operator=(const ShardHandle&) = delete;
+
+        Shard& get() { return *shard; }
+    };
+
+    Shard& localShard() {
+        thread_local ShardHandle handle;
+        return handle.get();
+    }
+
+    Totals collect() {
+        Registry& reg = registry();
+        Totals totals;
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        totals.merge(reg.retired);
+        for (const Shard* shard : reg.shards) {
+            totals.add(*shard);
+        }
+        return totals;
+    }
+
+    void appendLine(std::string& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    void appendLine(std::string& out, const char* format, ...) {
+        char line[256];
+        va_list args;
+        va_start(args, format);
+        int length = std::vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+        if (length > 0) out.append(line, std::min(static_cast<size_t>(length), sizeof(line) - 1));
+        out += '\n';
+    }
+
+    void writeHistogram(std::string& out, const char* name, const char* labels, const LatencyHistogram& histogram) {
+        for (int exponent = EXPORT_MIN_EXPONENT; exponent <= EXPORT_MAX_EXPONENT; ++exponent) {
+            uint64_t bound = uint64_t(1) << exponent;
+            appendLine(out, "%s_bucket{%s,le=\"%.9g\"} %llu", name, labels, static_cast<double>(bound) / 1e9,
+                       static_cast<unsigned long long>(histogram.countAtOrBelow(bound - 1)));
+        }
+        appendLine(out, "%s_bucket{%s,le=\"+Inf\"} %llu", name, labels,
+                   static_cast<unsigned long long>(histogram.getCount()));
+        appendLine(out, "%s_sum{%s} %.9g", name, labels, static_cast<double>(histogram.getSum()) / 1e9);
+        appendLine(out, "%s_count{%s} %llu", name, labels, static_cast<unsigned long long>(histogram.getCount()));
+    }
+}
+
+void Metrics::add(Counter counter, uint64_t amount) {
+    bump(localShard().counters[static_cast<size_t>(counter)], amount);
+}
+
+void Metrics::recordStage(Stage stage, uint64_t nanoseconds) {
+    localShard().stages[static_cast<size_t>(stage)].record(nanoseconds);
+}
+
+void Metrics::recordRequest(Route route, uint64_t nanoseconds, uint64_t bytesIn, uint64_t bytesOut, bool failed) {
+    RouteStats& stats = localShard().routes[static_cast<size_t>(route)];
+    stats.latency.record(nanoseconds);
+    bump(stats.bytesIn, bytesIn);
+    bump(stats.bytesOut, bytesOut);
+    if (failed) bump(stats.failures, 1);
+}
+
+void Metrics::addBytesOut(Route route, uint64_t bytes) {
+    bump(localShard().routes[static_cast<size_t>(route)].bytesOut, bytes);
+}
+
+const char* Metrics::routeMethod(Route route) {
+    return ROUTES[static_cast<size_t>(route)].method;
+}
+
+const char* Metrics::routePath(Route route) {
+    return ROUTES[static_cast<size_t>(route)].path;
+}
+
+const char* Metrics::stageName(Stage stage) {
+    return STAGES[static_cast<size_t>(stage)];
+}
+
+void Metrics::writePrometheus(std::string& out) {
+    Totals totals = collect();
+    char labels[128];
+
+    out += "# HELP stock_http_request_duration_seconds Time spent in route handlers.\n";
+    out += "# TYPE stock_http_request_duration_seconds histogram\n";
+    for (size_t r = 0; r < ROUTE_COUNT; ++r) {
+        std::snprintf(labels, sizeof(labels), "method=\"%s\",route=\"%s\"", ROUTES[r].method, ROUTES[r].path);
+        writeHistogram(out, "stock_http_request_duration_seconds", labels, totals.latency[r]);
+    }
+
+    struct RouteCounter {
+        const char* name;
+        const char* help;
+        const std::array<uint64_t, ROUTE_COUNT>& values;
+    };
+    const RouteCounter routeCounters[] = {
+        {"stock_http_request_errors_total", "Requests answered with a 4xx or 5xx status.", totals.failures},
+        {"stock_http_request_bytes_total", "Request body bytes received.", totals.bytesIn},
+        {"stock_http_response_bytes_total", "Response body bytes sent, before content coding.", totals.bytesOut}
+    };
+    for (const auto& counter : routeCounters) {
+        appendLine(out, "# HELP %s %s", counter.name, counter.help);
+        appendLine(out, "# TYPE %s counter", counter.name);
+        for (size_t r = 0; r < ROUTE_COUNT; ++r) {
+            appendLine(out, "%s{method=\"%s\",route=\"%s\"} %llu", counter.name, ROUTES[r].method, ROUTES[r].path,
+                       static_cast<unsigned long long>(counter.values[r]));
+        }
+    }
+
+    out += "# HELP stock_stage_duration_seconds Time spent in each processing stage.\n";
+    out += "# TYPE stock_stage_duration_seconds histogram\n";
+    for (size_t s = 0; s < STAGE_COUNT; ++s) {
+        std::snprintf(labels, sizeof(labels), "stage=\"%s\"", STAGES[s]);
+        writeHistogram(out, "stock_stage_duration_seconds", labels, totals.stages[s]);
+    }
+
+    struct GlobalCounter {
+        const char* name;
+        const char* help;
+        Counter counter;
+    };
+    const GlobalCounter globalCounters[] = {
+        {"stock_csv_rows_parsed_total", "Data rows accepted by the CSV parser.", Counter::CsvRowsParsed},
+        {"stock_csv_bytes_parsed_total", "CSV bytes handed to the parser.", Counter::CsvBytesParsed},
+        {"stock_algorithm_rows_total", "Price rows fed to prediction algorithms.", Counter::AlgorithmRows},
+        {"stock_arena_spill_bytes_total", "Request scratch bytes that did not fit the thread's arena block.", Counter::ArenaSpillBytes},
+        {"stock_compress_input_bytes_total", "Response bytes passed to gzip/deflate.", Counter::CompressInputBytes},
+        {"stock_compress_output_bytes_total", "Compressed response bytes produced by gzip/deflate.", Counter::CompressOutputBytes}
+    };
+    for (const auto& counter : globalCounters) {
+        appendLine(out, "# HELP %s %s", counter.name, counter.help);
+        appendLine(out, "# TYPE %s counter", counter.name);
+        appendLine(out, "%s %llu", counter.name,
+                   static_cast<unsigned long long>(totals.counters[static_cast<size_t>(counter.counter)]));
+    }
+}
@@ -0,0 +1,80 @@
+#include "../include/ParameterSweep.h"
+#include "../include/Metrics.h"
+#include "../include/PredictionAlgorithm.h"
+#include "../include/RequestArena.h"
+#include "../include/SeriesKernels.h"
+#include <algorithm>
+#include <stdexcept>
+
+SweepResult ParameterSweep::run(std::shared_ptr<const PriceSeries> series, std::vector<int> windows,
+                                std::vector<double> alphas, size_t begin, size_t end) {
+    if (windows.empty() && alphas.empty()) {
+        throw std::invalid_argument("A sweep needs at least one SMA window or EMA alpha");
+    }
+    if (windows.size() > MAX_SETTINGS || alphas.size() > MAX_SETTINGS) {
+        throw std::invalid_argument("A sweep takes at most " + std::to_string(MAX_SETTINGS) +
+                                    " settings per algorithm");
+    }
+
+    // The algorithms own the valid ranges; constructing them validates
+    size_t lookback = 0;
+    for (int window : windows) {
+        lookback = std::max(lookback, MovingAverageAlgorithm(window).getLookback());
+    }
+    size_t warmup = 0;
+    for (double alpha : alphas) {
+        warmup = std::max(warmup, ExponentialMovingAverageAlgorithm(alpha).getWarmup());
+    }
+
+    SweepResult result;
+    result.series = std::move(series);
+    result.windows = std::move(windows);
+    result.alphas = std::move(alphas);
+    end = std::min(end, result.series->size());
+    begin = std::min(begin, end);
+    result.firstBar = std::max(begin, lookback);
+    if (result.firstBar >= end) {
+        result.firstBar = end;
+        return result;
+    }
+    result.columns = end - result.firstBar;
+
+    size_t rows = result.windows.size() + result.alphas.size();
+    if (rows > MAX_CELLS / result.columns) {
+        throw std::invalid_argument("Sweep of " + std::to_string(rows) + " settings over " +
+                                    std::to_string(result.columns) + " bars exceeds " +
+                                    std::to_string(MAX_CELLS) + " values; narrow the date range");
+    }
+
+    Metrics::ScopedTimer timer(Metrics::Stage::AlgorithmCompute);
+    const double* closes = result.series->getCloses().data();
+
+    if (!result.windows.empty()) {
+        // Totals over [firstBar - lookback, end): enough history for the widest window
+        size_t base = result.firstBar - lookback;
+        size_t count = end - base;
+        std::pmr::vector<double> sums(count + 1, RequestArena::current());
+        std::pmr::vector<double> errors(count + 1, RequestArena::current());
+        SeriesKernels::prefixSums(closes + base, count, sums.data(), errors.data());
+        Metrics::add(Metrics::Counter::AlgorithmRows, count);
+
+        result.sma.resize(result.windows.size() * result.columns);
+        for (size_t k = 0; k < result.windows.size(); ++k) {
+            // The window ending at firstBar starts (lookback - window + 1) totals in
+            size_t offset = lookback + 1 - static_cast<size_t>(result.windows[k]);
+            SeriesKernels::windowMeans(sums.data() + offset, errors.data() + offset,
+                                       static_cast<size_t>(result.windows[k]),
+                                       result.sma.data() + k * result.columns, result.columns);
+        }
+    }
+
+    if (!result.alphas.empty()) {
+        // Warm up from the requested start, as a ranged prediction would
+        size_t start = begin > warmup ? begin - warmup : 0;
+        result.ema.resize(result.alphas.size() * result.columns);
+        SeriesKernels::exponentialMeans(closes + start, end - start, result.alphas.data(), result.alphas.size(),
+                                        result.firstBar - start, result.ema.data());
+        Metrics::add(Metrics::Counter::AlgorithmRows, end - start);
+    }
+    return result;
+}
@@ -1,20 +1,26 @@
 #include "../include/PredictionAlgorithm.h"
+#include "../include/SeriesKernels.h"
+#include <algorithm>
+#include <cmath>
 #include <numeric>
 #include <stdexcept>
 #include <sstream>
 
-std::vector<double> PredictionAlgorithm::getClosingPrices(const std::vector<StockData>& data) {
-    std::vector<double> prices;
-    prices.reserve(data.size());
-    for (const auto& stock : data) {
-        prices.push_back(stock.getClose());
+std::unique_ptr<PredictionAlgorithm> PredictionAlgorithm::withParameters(const nlohmann::json& params) const {
+    auto configured = clone();
+    if (!params.is_null()) {
+        if (!params.is_object()) {
+            throw std::invalid_argument("Algorithm parameters must be a JSON object");
+        }
+        configured->configure(params);
     }
-    return prices;
+    return configured;
 }
 
 // Moving Average Implementation
 MovingAverageAlgorithm::MovingAverageAlgorithm(int window) : windowSize(window) {
     validate();
+    meanKernel = SeriesKernels::fixedWindowMean(static_cast<size_t>(windowSize));
 }
 
 void MovingAverageAlgorithm::configure(const nlohmann::json& params) {
@@ -22,6 +28,7 @@ void MovingAverageAlgorithm::configure(const nlohmann::json& params) {
         windowSize = params["window_size"].get<int>();
     }
     validate();
+    meanKernel = SeriesKernels::fixedWindowMean(static_cast<size_t>(windowSize));
 }
 
 nlohmann::json MovingAverageAlgorithm::getParameters() const {
@@ -40,21 +47,102 @@ void MovingAverageAlgorithm::validate() const {
     }
 }
 
-std::vector<double> MovingAverageAlgorithm::predict(const std::vector<StockData>& data) {
-    std::vector<double> prices = getClosingPrices(data);
+std::vector<double> MovingAverageAlgorithm::predict(const PriceSeries& data) const {
     std::vector<double> predictions;
+    predictInto(data, predictions);
+    return predictions;
+}
+
+void MovingAverageAlgorithm::predictInto(const PriceSeries& data, std::vector<double>& predictions) const {
+    ColumnView<double> prices = getClosingPrices(data);
     
     if (prices.size() < static_cast<size_t>(windowSize)) {
         throw std::runtime_error("Insufficient data points for the specified window size");
     }
 
-    predictions.reserve(prices.size() - windowSize + 1);
-    for (size_t i = windowSize; i <= prices.size(); ++i) {
-        double sum = std::accumulate(prices.begin() + (i - windowSize), prices.begin() + i, 0.0);
-        predictions.push_back(sum / windowSize);
+    predictions.resize(prices.size() - windowSize + 1);
+    if (meanKernel) {
+        meanKernel(prices.data(), prices.size(), predictions.data());
+    } else {
+        // Rolling sum: O(n) regardless of the window size
+        SeriesKernels::rollingMean(prices.data(), prices.size(), windowSize, predictions.data());
     }
+}
 
-    return predictions;
+std::unique_ptr<PredictionAlgorithm> MovingAverageAlgorithm::clone() const {
+    return std::make_unique<MovingAverageAlgorithm>(*this);
+}
+
+namespace {
+    // Ring buffer of the last windowSize closes plus their running sum
+    class MovingAverageState : public OnlineState {
+    private:
+        std::vector<double> window;
+        size_t head = 0;
+        size_t count = 0;
+        size_t sinceResum = 0;
+        double sum = 0.0;
+
+    public:
+        explicit MovingAverageState(size_t windowSize) : window(windowSize) {}
+
+        void seed(ColumnView<double> closes, const std::vector<double>&) override {
+            head = count = sinceResum = 0;
+            sum = 0.0;
+            size_t keep = std::min(closes.size(), window.size());
+            double ignored;
+            for (double close : closes.subview(closes.size() - keep, keep)) {
+                update(close, ignored);
+            }
+        }
+
+        bool update(double close, double& prediction) override {
+            if (count == window.size()) {
+                sum -= window[head];
+            } else {
+                ++count;
+            }
+            window[head] = close;
+            sum += close;
+            head = (head + 1) % window.size();
+
+            // Same drift guard as the batch kernel
+            if (++sinceResum == SeriesKernels::RESUM_INTERVAL) {
+                sum = std::accumulate(window.begin(), window.begin() + count, 0.0);
+                sinceResum = 0;
+            }
+
+            if (count < window.size()) return false;
+            prediction = sum / static_cast<double>(window.size());
+            return true;
+        }
+    };
+
+    class ExponentialMovingAverageState : public OnlineState {
+    private:
+        double alpha;
+        double ema = 0.0;
+        bool initialized = false;
+
+    public:
+        explicit ExponentialMovingAverageState(double smoothingFactor) : alpha(smoothingFactor) {}
+
+        void seed(ColumnView<double>, const std::vector<double>& predictions) override {
+            initialized = !predictions.empty();
+            ema = initialized ? predictions.back() : 0.0;
+        }
+
+        bool update(double close, double& prediction) override {
+            ema = initialized ? alpha * close + (1 - alpha) * ema : close;
+            initialized = true;
+            prediction = ema;
+            return true;
+        }
+    };
+}
+
+std::unique_ptr<OnlineState> MovingAverageAlgorithm::createOnlineState() const {
+    return std::make_unique<MovingAverageState>(static_cast<size_t>(windowSize));
 }
 
 std::string MovingAverageAlgorithm::getDescription() const {
@@ -90,24 +178,42 @@ void ExponentialMovingAverageAlgorithm::validate() const {
     }
 }
 
-std::vector<double> ExponentialMovingAverageAlgorithm::predict(const std::vector<StockData>& data) {
-    std::vector<double> prices = getClosingPrices(data);
+std::vector<double> ExponentialMovingAverageAlgorithm::predict(const PriceSeries& data) const {
     std::vector<double> predictions;
+    predictInto(data, predictions);
+    return predictions;
+}
+
+void ExponentialMovingAverageAlgorithm::predictInto(const PriceSeries& data, std::vector<double>& predictions) const {
+    ColumnView<double> prices = getClosingPrices(data);
 
     if (prices.empty()) {
         throw std::runtime_error("No data points provided for prediction");
     }
 
-    predictions.reserve(prices.size());
+    predictions.resize(prices.size());
     double ema = prices[0];
-    predictions.push_back(ema);
+    predictions[0] = ema;
 
     for (size_t i = 1; i < prices.size(); ++i) {
         ema = smoothingFactor * prices[i] + (1 - smoothingFactor) * ema;
-        predictions.push_back(ema);
+        predictions[i] = ema;
     }
+}
 
-    return predictions;
+std::unique_ptr<PredictionAlgorithm> ExponentialMovingAverageAlgorithm::clone() const {
+    return std::make_unique<ExponentialMovingAverageAlgorithm>(*this);
+}
+
+std::unique_ptr<OnlineState> ExponentialMovingAverageAlgorithm::createOnlineState() const {
+    return std::make_unique<ExponentialMovingAverageState>(smoothingFactor);
+}
+
+size_t ExponentialMovingAverageAlgorithm::getWarmup() const {
+    // Bars older than k contribute a weight of (1 - alpha)^k; stop once that
+    // is below 1e-12
+    if (smoothingFactor >= 1.0) return 0;
+    return static_cast<size_t>(std::ceil(std::log(1e-12) / std::log(1.0 - smoothingFactor)));
 }
 
 std::string ExponentialMovingAverageAlgorithm::getDescription() const {
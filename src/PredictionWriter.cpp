@@ -0,0 +1,90 @@
+#include "../include/PredictionWriter.h"
+#include "../include/Log.h"
+
+PredictionWriter::PredictionWriter(FileHandler& handler, size_t queueCapacity)
+    : fileHandler(handler), capacity(queueCapacity == 0 ? 1 : queueCapacity) {
+    worker = std::thread(&PredictionWriter::run, this);
+}
+
+PredictionWriter::~PredictionWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+bool PredictionWriter::enqueue(const std::string& symbol, std::shared_ptr<const PriceSeries> series, size_t firstBar,
+                               std::shared_ptr<const std::vector<double>> predictions) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = pending.find(symbol);
+        if (it != pending.end()) {
+            // Keep the symbol's place in line; only the newest result is written
+            it->second = Job{std::move(series), firstBar, std::move(predictions)};
+            ++stats.queued;
+            ++stats.coalesced;
+            return true;
+        }
+        if (pending.size() >= capacity) {
+            ++stats.dropped;
+            return false;
+        }
+        pending.emplace(symbol, Job{std::move(series), firstBar, std::move(predictions)});
+        order.push_back(symbol);
+        ++stats.queued;
+    }
+    wake.notify_one();
+    return true;
+}
+
+void PredictionWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    drained.wait(lock, [this] { return order.empty() && !writing; });
+}
+
+PersistStats PredictionWriter::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    PersistStats snapshot = stats;
+    snapshot.pending = pending.size();
+    return snapshot;
+}
+
+void PredictionWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || !order.empty(); });
+        if (order.empty()) {
+            // Only reached when stopping with nothing left to write
+            return;
+        }
+
+        std::string symbol = std::move(order.front());
+        order.pop_front();
+        auto it = pending.find(symbol);
+        Job job = std::move(it->second);
+        pending.erase(it);
+        writing = true;
+
+        lock.unlock();
+        bool ok = true;
+        try {
+            write(symbol, job);
+        } catch (const std::exception& e) {
+            ok = false;
+            LOG_ERROR("Could not persist predictions for " << symbol << ": " << e.what());
+        }
+        lock.lock();
+
+        writing = false;
+        ++(ok ? stats.written : stats.failed);
+        if (order.empty()) {
+            drained.notify_all();
+        }
+    }
+}
+
+void PredictionWriter::write(const std::string& symbol, const Job& job) {
+    fileHandler.writePredictions(symbol, *job.series, job.firstBar, *job.predictions);
+}
@@ -0,0 +1,110 @@
+#include "../include/PriceSeries.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+PriceSeries::PriceSeries(std::string symbol) : symbol(std::move(symbol)) {}
+
+PriceSeries::PriceSeries(std::string symbol, const ExternalColumns& columns,
+                         std::shared_ptr<const void> owner, size_t ownerBytes)
+    : symbol(std::move(symbol)), external(columns),
+      externalOwner(std::move(owner)), externalBytes(ownerBytes) {
+    if (!externalOwner) {
+        throw std::invalid_argument("External columns need an owner");
+    }
+}
+
+void PriceSeries::reserve(size_t rows) {
+    opens.reserve(rows);
+    highs.reserve(rows);
+    lows.reserve(rows);
+    closes.reserve(rows);
+    volumes.reserve(rows);
+    timestamps.reserve(rows);
+    dateOffsets.reserve(rows + 1);
+    // ISO dates are 10 characters; intraday timestamps grow the buffer as needed
+    dateChars.reserve(rows * 10);
+}
+
+void PriceSeries::append(std::string_view date, int64_t timestamp,
+                         double open, double high, double low, double close, double volume) {
+    if (isExternal()) {
+        throw std::logic_error("Cannot append to a series backed by external storage");
+    }
+    if (!timestamps.empty() && timestamp <= timestamps.back()) {
+        throw std::invalid_argument("Date " + std::string(date) + " is not after the previous row's date " +
+                                    std::string(getDate(size() - 1)));
+    }
+    if (dateChars.size() + date.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Date column exceeds 4 GiB for symbol: " + symbol);
+    }
+
+    opens.push_back(open);
+    highs.push_back(high);
+    lows.push_back(low);
+    closes.push_back(close);
+    volumes.push_back(volume);
+    timestamps.push_back(timestamp);
+    dateChars.append(date.data(), date.size());
+    dateOffsets.push_back(static_cast<uint32_t>(dateChars.size()));
+}
+
+std::string_view PriceSeries::getDate(size_t index) const {
+    const uint32_t* offsets = isExternal() ? external.dateOffsets : dateOffsets.data();
+    const char* chars = isExternal() ? external.dateChars : dateChars.data();
+    return std::string_view(chars + offsets[index], offsets[index + 1] - offsets[index]);
+}
+
+size_t PriceSeries::lowerBound(int64_t timestamp) const {
+    auto column = getTimestamps();
+    return static_cast<size_t>(std::lower_bound(column.begin(), column.end(), timestamp) - column.begin());
+}
+
+PriceSeries PriceSeries::slice(const std::shared_ptr<const PriceSeries>& series, size_t begin, size_t end) {
+    if (begin > end || end > series->size()) {
+        throw std::out_of_range("Slice [" + std::to_string(begin) + ", " + std::to_string(end) +
+                                ") is outside a series of " + std::to_string(series->size()) + " rows");
+    }
+    ExternalColumns columns;
+    columns.rows = end - begin;
+    columns.opens = series->getOpens().data() + begin;
+    columns.highs = series->getHighs().data() + begin;
+    columns.lows = series->getLows().data() + begin;
+    columns.closes = series->getCloses().data() + begin;
+    columns.volumes = series->getVolumes().data() + begin;
+    columns.timestamps = series->getTimestamps().data() + begin;
+    // Offsets still index the parent's characters, so share its base pointer
+    columns.dateOffsets = series->getDateOffsets().data() + begin;
+    columns.dateChars = series->getDateChars().data() - series->getDateOffsets()[0];
+    return PriceSeries(series->getSymbol(), columns, series, 0);
+}
+
+ColumnView<uint32_t> PriceSeries::getDateOffsets() const {
+    return isExternal() ? ColumnView<uint32_t>(external.dateOffsets, external.rows + 1)
+                        : ColumnView<uint32_t>(dateOffsets);
+}
+
+std::string_view PriceSeries::getDateChars() const {
+    if (isExternal()) {
+        return std::string_view(external.dateChars + external.dateOffsets[0],
+                                external.dateOffsets[external.rows] - external.dateOffsets[0]);
+    }
+    return dateChars;
+}
+
+StockData PriceSeries::row(size_t index) const {
+    return StockData(symbol, std::string(getDate(index)),
+                     getOpens()[index], getHighs()[index], getLows()[index],
+                     getCloses()[index], getVolumes()[index]);
+}
+
+size_t PriceSeries::memoryUsage() const {
+    return sizeof(*this)
+         + externalBytes
+         + symbol.capacity()
+         + (opens.capacity() + highs.capacity() + lows.capacity()
+            + closes.capacity() + volumes.capacity()) * sizeof(double)
+         + timestamps.capacity() * sizeof(int64_t)
+         + dateChars.capacity()
+         + dateOffsets.capacity() * sizeof(uint32_t);
+}
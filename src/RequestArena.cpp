@@ -0,0 +1,57 @@
+#include "../include/RequestArena.h"
+#include "../include/Metrics.h"
+#include <algorithm>
+#include <memory>
+
+namespace {
+    struct ThreadBlock {
+        std::unique_ptr<std::byte[]> data;
+        size_t size = 0;
+        size_t wanted = RequestArena::INITIAL_BLOCK_BYTES;
+        bool inUse = false;
+    };
+
+    thread_local ThreadBlock block;
+    thread_local RequestArena* innermost = nullptr;
+}
+
+void* RequestArena::SpillResource::do_allocate(size_t size, size_t alignment) {
+    bytes += size;
+    return std::pmr::new_delete_resource()->allocate(size, alignment);
+}
+
+void RequestArena::SpillResource::do_deallocate(void* pointer, size_t size, size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(pointer, size, alignment);
+}
+
+RequestArena::RequestArena() : outer(innermost), ownsBlock(!block.inUse) {
+    if (ownsBlock) {
+        // Grown between requests only, never while a request holds the block
+        if (block.size < block.wanted) {
+            block.data.reset(new std::byte[block.wanted]);
+            block.size = block.wanted;
+        }
+        block.inUse = true;
+        arena.emplace(block.data.get(), block.size, &spill);
+    } else {
+        arena.emplace(&spill);
+    }
+    innermost = this;
+}
+
+RequestArena::~RequestArena() {
+    // Hands the spilled buffers back before the block is reused
+    arena.reset();
+    innermost = outer;
+    if (!ownsBlock) return;
+
+    block.inUse = false;
+    if (spill.bytes > 0) {
+        block.wanted = std::min(MAX_BLOCK_BYTES, block.size + spill.bytes);
+        Metrics::add(Metrics::Counter::ArenaSpillBytes, spill.bytes);
+    }
+}
+
+std::pmr::memory_resource* RequestArena::current() {
+    return innermost ? innermost->resource() : std::pmr::get_default_resource();
+}
@@ -0,0 +1,563 @@
+#include "../include/SeriesKernels.h"
+#include "../include/WindowKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define STOCK_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    double directSum(const double* values, size_t count) {
+        double sum = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            sum += values[i];
+        }
+        return sum;
+    }
+
+    // Kahan-compensated accumulation: sum + value with the lost low-order
+    // bits carried in compensation
+    inline void compensatedAdd(double& sum, double& compensation, double value) {
+        double y = value - compensation;
+        double t = sum + y;
+        compensation = (t - sum) - y;
+        sum = t;
+    }
+
+    // Emits `outputs` means starting at values[0]. The running sum holds the
+    // window minus its newest element: add the incoming value, emit, then
+    // drop the outgoing one.
+    void rollingMeanRange(const double* values, size_t window, double* out, size_t outputs) {
+        const double divisor = static_cast<double>(window);
+        size_t start = 0;
+
+        while (start < outputs) {
+            size_t end = std::min(outputs, start + SeriesKernels::RESUM_INTERVAL);
+            double sum = directSum(values + start, window - 1);
+            double compensation = 0.0;
+
+            for (size_t i = start; i < end; ++i) {
+                compensatedAdd(sum, compensation, values[i + window - 1]);
+                out[i] = sum / divisor;
+                compensatedAdd(sum, compensation, -values[i]);
+            }
+            start = end;
+        }
+    }
+
+    // Loops whose iterations are independent are written once, as bodies
+    // that are inlined into a plain and an AVX2 entry point; the compiler
+    // vectorizes both
+    STOCK_ALWAYS_INLINE void windowMeansBody(const double* sums, const double* errors, size_t window,
+                                             double* out, size_t outputs) {
+        const double scale = 1.0 / static_cast<double>(window);
+        for (size_t i = 0; i < outputs; ++i) {
+            out[i] = ((sums[i + window] - sums[i]) + (errors[i + window] - errors[i])) * scale;
+        }
+    }
+
+    STOCK_ALWAYS_INLINE void priceChangesBody(const double* values, size_t count, double* gains, double* losses) {
+        for (size_t i = 0; i < count; ++i) {
+            double change = values[i + 1] - values[i];
+            gains[i] = change > 0.0 ? change : 0.0;
+            losses[i] = change < 0.0 ? -change : 0.0;
+        }
+    }
+
+    STOCK_ALWAYS_INLINE void trueRangesBody(const double* highs, const double* lows, const double* previousCloses,
+                                            size_t count, double* out) {
+        for (size_t i = 0; i < count; ++i) {
+            double range = highs[i] - lows[i];
+            double up = std::fabs(highs[i] - previousCloses[i]);
+            double down = std::fabs(lows[i] - previousCloses[i]);
+            out[i] = std::max(range, std::max(up, down));
+        }
+    }
+
+    STOCK_ALWAYS_INLINE void relativeStrengthBody(const double* gains, const double* losses, size_t count,
+                                                  double* out) {
+        for (size_t i = 0; i < count; ++i) {
+            // 50 + 50 (g - l) / (g + l) is 100 g / (g + l), and 50 when both
+            // are 0 without needing a branch
+            double total = std::max(gains[i] + losses[i], std::numeric_limits<double>::min());
+            out[i] = 50.0 + 50.0 * (gains[i] - losses[i]) / total;
+        }
+    }
+
+    void windowMeansScalar(const double* sums, const double* errors, size_t window, double* out, size_t outputs) {
+        windowMeansBody(sums, errors, window, out, outputs);
+    }
+
+    void priceChangesScalar(const double* values, size_t count, double* gains, double* losses) {
+        priceChangesBody(values, count, gains, losses);
+    }
+
+    void trueRangesScalar(const double* highs, const double* lows, const double* previousCloses, size_t count,
+                          double* out) {
+        trueRangesBody(highs, lows, previousCloses, count, out);
+    }
+
+    void relativeStrengthScalar(const double* gains, const double* losses, size_t count, double* out) {
+        relativeStrengthBody(gains, losses, count, out);
+    }
+
+    void bandsScalar(const double* means, const double* variances, size_t count, double width, double* out) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = means[i] + width * std::sqrt(std::max(variances[i], 0.0));
+        }
+    }
+
+    void linearRecurrenceScalar(const double* inputs, size_t count, double decay, double gain,
+                                const double*, double& state, double* out) {
+        double level = state;
+        for (size_t i = 0; i < count; ++i) {
+            level = decay * level + gain * inputs[i];
+            out[i] = level;
+        }
+        state = level;
+    }
+
+    template <typename Window>
+    void fixedWindowMeanScalar(const double* values, size_t count, double* out) {
+        WindowKernels::slidingMean<Window>(values, count, out);
+    }
+
+    constexpr size_t EMA_LANES = 4;
+
+    // Advances up to EMA_LANES alphas side by side. The recurrences are
+    // independent, so they overlap instead of each waiting on its own
+    // previous step.
+    void exponentialMeansGroup(const double* values, size_t count, const double* alphas, size_t lanes,
+                               size_t skip, double* const* rows) {
+        double weight[EMA_LANES], decay[EMA_LANES], ema[EMA_LANES];
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            weight[lane] = alphas[lane];
+            decay[lane] = 1 - alphas[lane];
+            ema[lane] = values[0];
+            if (skip == 0) rows[lane][0] = values[0];
+        }
+
+        size_t t = 1;
+        for (; t < skip; ++t) {
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                ema[lane] = weight[lane] * values[t] + decay[lane] * ema[lane];
+            }
+        }
+        for (; t < count; ++t) {
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                ema[lane] = weight[lane] * values[t] + decay[lane] * ema[lane];
+                rows[lane][t - skip] = ema[lane];
+            }
+        }
+    }
+
+    void exponentialMeansScalar(const double* values, size_t count, const double* alphas, size_t alphaCount,
+                                size_t skip, double* out) {
+        const size_t columns = count - skip;
+        for (size_t k = 0; k < alphaCount; k += EMA_LANES) {
+            size_t lanes = std::min(EMA_LANES, alphaCount - k);
+            double* rows[EMA_LANES];
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                rows[lane] = out + (k + lane) * columns;
+            }
+            exponentialMeansGroup(values, count, alphas + k, lanes, skip, rows);
+        }
+    }
+
+#ifdef STOCK_KERNELS_X86
+    __attribute__((target("avx2")))
+    inline void transpose4(__m256d& r0, __m256d& r1, __m256d& r2, __m256d& r3) {
+        __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+        __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+        __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+        __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+        r0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+        r1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+        r2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+        r3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+    }
+
+    __attribute__((target("avx2")))
+    inline void compensatedAdd(__m256d& sum, __m256d& compensation, __m256d value) {
+        __m256d y = _mm256_sub_pd(value, compensation);
+        __m256d t = _mm256_add_pd(sum, y);
+        compensation = _mm256_sub_pd(_mm256_sub_pd(t, sum), y);
+        sum = t;
+    }
+
+    // Splits the output into four contiguous stretches and advances one
+    // running sum per stretch in each vector lane. Four consecutive steps are
+    // loaded per stretch and transposed so every lane sees its own stream.
+    __attribute__((target("avx2")))
+    void rollingMeanAvx2(const double* values, size_t count, size_t window, double* out) {
+        const size_t outputs = count - window + 1;
+        const size_t stretch = (outputs / 4) & ~size_t(3);
+        if (stretch < 16) {
+            rollingMeanRange(values, window, out, outputs);
+            return;
+        }
+
+        const __m256d divisor = _mm256_set1_pd(static_cast<double>(window));
+        const __m256d zero = _mm256_setzero_pd();
+        const double* in[4];
+        double* dst[4];
+        for (size_t lane = 0; lane < 4; ++lane) {
+            in[lane] = values + lane * stretch;
+            dst[lane] = out + lane * stretch;
+        }
+
+        size_t start = 0;
+        while (start < stretch) {
+            size_t end = std::min(stretch, start + SeriesKernels::RESUM_INTERVAL);
+            __m256d sum = _mm256_setr_pd(directSum(in[0] + start, window - 1),
+                                         directSum(in[1] + start, window - 1),
+                                         directSum(in[2] + start, window - 1),
+                                         directSum(in[3] + start, window - 1));
+            __m256d compensation = zero;
+
+            for (size_t i = start; i < end; i += 4) {
+                __m256d add0 = _mm256_loadu_pd(in[0] + i + window - 1);
+                __m256d add1 = _mm256_loadu_pd(in[1] + i + window - 1);
+                __m256d add2 = _mm256_loadu_pd(in[2] + i + window - 1);
+                __m256d add3 = _mm256_loadu_pd(in[3] + i + window - 1);
+                __m256d sub0 = _mm256_loadu_pd(in[0] + i);
+                __m256d sub1 = _mm256_loadu_pd(in[1] + i);
+                __m256d sub2 = _mm256_loadu_pd(in[2] + i);
+                __m256d sub3 = _mm256_loadu_pd(in[3] + i);
+                transpose4(add0, add1, add2, add3);
+                transpose4(sub0, sub1, sub2, sub3);
+
+                compensatedAdd(sum, compensation, add0);
+                __m256d mean0 = _mm256_div_pd(sum, divisor);
+                compensatedAdd(sum, compensation, _mm256_sub_pd(zero, sub0));
+                compensatedAdd(sum, compensation, add1);
+                __m256d mean1 = _mm256_div_pd(sum, divisor);
+                compensatedAdd(sum, compensation, _mm256_sub_pd(zero, sub1));
+                compensatedAdd(sum, compensation, add2);
+                __m256d mean2 = _mm256_div_pd(sum, divisor);
+                compensatedAdd(sum, compensation, _mm256_sub_pd(zero, sub2));
+                compensatedAdd(sum, compensation, add3);
+                __m256d mean3 = _mm256_div_pd(sum, divisor);
+                compensatedAdd(sum, compensation, _mm256_sub_pd(zero, sub3));
+
+                transpose4(mean0, mean1, mean2, mean3);
+                _mm256_storeu_pd(dst[0] + i, mean0);
+                _mm256_storeu_pd(dst[1] + i, mean1);
+                _mm256_storeu_pd(dst[2] + i, mean2);
+                _mm256_storeu_pd(dst[3] + i, mean3);
+            }
+            start = end;
+        }
+
+        // Whatever did not divide evenly into the four stretches
+        size_t done = 4 * stretch;
+        rollingMeanRange(values + done, window, out + done, outputs - done);
+    }
+
+    __attribute__((target("avx2")))
+    void windowMeansAvx2(const double* sums, const double* errors, size_t window, double* out, size_t outputs) {
+        windowMeansBody(sums, errors, window, out, outputs);
+    }
+
+    __attribute__((target("avx2")))
+    void priceChangesAvx2(const double* values, size_t count, double* gains, double* losses) {
+        priceChangesBody(values, count, gains, losses);
+    }
+
+    __attribute__((target("avx2")))
+    void trueRangesAvx2(const double* highs, const double* lows, const double* previousCloses, size_t count,
+                        double* out) {
+        trueRangesBody(highs, lows, previousCloses, count, out);
+    }
+
+    __attribute__((target("avx2")))
+    void relativeStrengthAvx2(const double* gains, const double* losses, size_t count, double* out) {
+        relativeStrengthBody(gains, losses, count, out);
+    }
+
+    // std::sqrt may set errno, which keeps the compiler from vectorizing
+    // the plain loop; the square root instruction is used directly instead
+    __attribute__((target("avx2")))
+    void bandsAvx2(const double* means, const double* variances, size_t count, double width, double* out) {
+        const __m256d scale = _mm256_set1_pd(width);
+        const __m256d zero = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m256d deviation = _mm256_sqrt_pd(_mm256_max_pd(_mm256_loadu_pd(variances + i), zero));
+            _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(means + i), _mm256_mul_pd(scale, deviation)));
+        }
+        bandsScalar(means + i, variances + i, count - i, width, out + i);
+    }
+
+    // Each step depends on the previous one, so a single chain runs at the
+    // latency of a multiply and an add. The recurrence is linear, though: a
+    // stretch run from 0 differs from the true values only by the carried-in
+    // state times decay^(j + 1). Four stretches advance in the vector lanes
+    // (transposed as in rollingMeanAvx2), then each is corrected in order
+    // with full-width multiply-adds.
+    __attribute__((target("avx2")))
+    void linearRecurrenceAvx2(const double* inputs, size_t count, double decay, double gain,
+                              const double* powers, double& state, double* out) {
+        const size_t stretch = (count / 4) & ~size_t(3);
+        if (stretch < 16) {
+            linearRecurrenceScalar(inputs, count, decay, gain, powers, state, out);
+            return;
+        }
+
+        const __m256d scale = _mm256_set1_pd(decay);
+        const __m256d weight = _mm256_set1_pd(gain);
+        __m256d level = _mm256_setzero_pd();
+        for (size_t i = 0; i < stretch; i += 4) {
+            __m256d x0 = _mm256_loadu_pd(inputs + i);
+            __m256d x1 = _mm256_loadu_pd(inputs + stretch + i);
+            __m256d x2 = _mm256_loadu_pd(inputs + 2 * stretch + i);
+            __m256d x3 = _mm256_loadu_pd(inputs + 3 * stretch + i);
+            transpose4(x0, x1, x2, x3);
+
+            __m256d y0 = _mm256_add_pd(_mm256_mul_pd(scale, level), _mm256_mul_pd(weight, x0));
+            __m256d y1 = _mm256_add_pd(_mm256_mul_pd(scale, y0), _mm256_mul_pd(weight, x1));
+            __m256d y2 = _mm256_add_pd(_mm256_mul_pd(scale, y1), _mm256_mul_pd(weight, x2));
+            __m256d y3 = _mm256_add_pd(_mm256_mul_pd(scale, y2), _mm256_mul_pd(weight, x3));
+            level = y3;
+
+            transpose4(y0, y1, y2, y3);
+            _mm256_storeu_pd(out + i, y0);
+            _mm256_storeu_pd(out + stretch + i, y1);
+            _mm256_storeu_pd(out + 2 * stretch + i, y2);
+            _mm256_storeu_pd(out + 3 * stretch + i, y3);
+        }
+
+        double carried = state;
+        for (size_t lane = 0; lane < 4; ++lane) {
+            double* dst = out + lane * stretch;
+            const __m256d carry = _mm256_set1_pd(carried);
+            for (size_t j = 0; j < stretch; j += 4) {
+                __m256d fix = _mm256_mul_pd(_mm256_loadu_pd(powers + j + 1), carry);
+                _mm256_storeu_pd(dst + j, _mm256_add_pd(_mm256_loadu_pd(dst + j), fix));
+            }
+            carried = dst[stretch - 1];
+        }
+
+        // Whatever did not divide evenly into the four stretches
+        state = carried;
+        size_t done = 4 * stretch;
+        linearRecurrenceScalar(inputs + done, count - done, decay, gain, powers, state, out + done);
+    }
+
+    template <typename Window>
+    __attribute__((target("avx2")))
+    void fixedWindowMeanAvx2(const double* values, size_t count, double* out) {
+        WindowKernels::slidingMean<Window>(values, count, out);
+    }
+
+    // Same arithmetic as ExponentialMovingAverageAlgorithm (no fused
+    // multiply-add), so the rows match predict() exactly
+    __attribute__((target("avx2")))
+    inline __m256d emaStep(__m256d ema, __m256d weight, __m256d decay, double value) {
+        return _mm256_add_pd(_mm256_mul_pd(weight, _mm256_set1_pd(value)), _mm256_mul_pd(decay, ema));
+    }
+
+    // Four alphas per vector. Four bars are stepped at a time, giving one
+    // vector per bar, and transposed into one vector per alpha so each row
+    // is stored contiguously.
+    __attribute__((target("avx2")))
+    void exponentialMeansAvx2(const double* values, size_t count, const double* alphas, size_t alphaCount,
+                              size_t skip, double* out) {
+        const size_t columns = count - skip;
+        const __m256d one = _mm256_set1_pd(1.0);
+        size_t k = 0;
+
+        for (; k + 4 <= alphaCount; k += 4) {
+            double* rows[4];
+            for (size_t lane = 0; lane < 4; ++lane) {
+                rows[lane] = out + (k + lane) * columns;
+                if (skip == 0) rows[lane][0] = values[0];
+            }
+            const __m256d weight = _mm256_loadu_pd(alphas + k);
+            const __m256d decay = _mm256_sub_pd(one, weight);
+            __m256d ema = _mm256_set1_pd(values[0]);
+
+            size_t t = 1;
+            for (; t < skip; ++t) {
+                ema = emaStep(ema, weight, decay, values[t]);
+            }
+            for (; t + 4 <= count; t += 4) {
+                __m256d bar0 = emaStep(ema, weight, decay, values[t]);
+                __m256d bar1 = emaStep(bar0, weight, decay, values[t + 1]);
+                __m256d bar2 = emaStep(bar1, weight, decay, values[t + 2]);
+                __m256d bar3 = emaStep(bar2, weight, decay, values[t + 3]);
+                ema = bar3;
+                transpose4(bar0, bar1, bar2, bar3);
+                _mm256_storeu_pd(rows[0] + t - skip, bar0);
+                _mm256_storeu_pd(rows[1] + t - skip, bar1);
+                _mm256_storeu_pd(rows[2] + t - skip, bar2);
+                _mm256_storeu_pd(rows[3] + t - skip, bar3);
+            }
+            for (; t < count; ++t) {
+                ema = emaStep(ema, weight, decay, values[t]);
+                double lanes[4];
+                _mm256_storeu_pd(lanes, ema);
+                for (size_t lane = 0; lane < 4; ++lane) {
+                    rows[lane][t - skip] = lanes[lane];
+                }
+            }
+        }
+
+        // Alphas that do not fill a vector
+        if (k < alphaCount) {
+            exponentialMeansScalar(values, count, alphas + k, alphaCount - k, skip, out + k * columns);
+        }
+    }
+#endif
+
+    using RollingMeanFn = void (*)(const double*, size_t, size_t, double*);
+    using WindowMeansFn = void (*)(const double*, const double*, size_t, double*, size_t);
+    using PriceChangesFn = void (*)(const double*, size_t, double*, double*);
+    using TrueRangesFn = void (*)(const double*, const double*, const double*, size_t, double*);
+    using RelativeStrengthFn = void (*)(const double*, const double*, size_t, double*);
+    using BandsFn = void (*)(const double*, const double*, size_t, double, double*);
+    using ExponentialMeansFn = void (*)(const double*, size_t, const double*, size_t, size_t, double*);
+    using LinearRecurrenceFn = void (*)(const double*, size_t, double, double, const double*, double&, double*);
+
+    // One instantiation per specialised window and instruction set
+    struct FixedWindowKernel {
+        size_t window;
+        SeriesKernels::WindowMeanFn scalar;
+        SeriesKernels::WindowMeanFn avx2;
+    };
+
+    template <typename Window>
+    constexpr FixedWindowKernel fixedWindowKernel() {
+#ifdef STOCK_KERNELS_X86
+        return {Window::WINDOW, fixedWindowMeanScalar<Window>, fixedWindowMeanAvx2<Window>};
+#else
+        return {Window::WINDOW, fixedWindowMeanScalar<Window>, fixedWindowMeanScalar<Window>};
+#endif
+    }
+
+    const FixedWindowKernel FIXED_WINDOW_KERNELS[] = {
+        fixedWindowKernel<WindowKernels::Window5<double>>(),
+        fixedWindowKernel<WindowKernels::Window10<double>>(),
+        fixedWindowKernel<WindowKernels::Window20<double>>(),
+        fixedWindowKernel<WindowKernels::Window50<double>>(),
+        fixedWindowKernel<WindowKernels::Window100<double>>(),
+        fixedWindowKernel<WindowKernels::Window200<double>>()
+    };
+
+    struct Dispatch {
+        RollingMeanFn rollingMean = SeriesKernels::rollingMeanScalar;
+        WindowMeansFn windowMeans = windowMeansScalar;
+        PriceChangesFn priceChanges = priceChangesScalar;
+        TrueRangesFn trueRanges = trueRangesScalar;
+        RelativeStrengthFn relativeStrength = relativeStrengthScalar;
+        BandsFn bands = bandsScalar;
+        ExponentialMeansFn exponentialMeans = exponentialMeansScalar;
+        LinearRecurrenceFn linearRecurrence = linearRecurrenceScalar;
+        bool avx2 = false;
+        const char* name = "scalar";
+
+        Dispatch() {
+#ifdef STOCK_KERNELS_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) {
+                rollingMean = rollingMeanAvx2;
+                windowMeans = windowMeansAvx2;
+                priceChanges = priceChangesAvx2;
+                trueRanges = trueRangesAvx2;
+                relativeStrength = relativeStrengthAvx2;
+                bands = bandsAvx2;
+                exponentialMeans = exponentialMeansAvx2;
+                linearRecurrence = linearRecurrenceAvx2;
+                avx2 = true;
+                name = "avx2";
+            }
+#endif
+        }
+    };
+
+    const Dispatch& dispatch() {
+        static const Dispatch instance;
+        return instance;
+    }
+}
+
+void SeriesKernels::rollingMean(const double* values, size_t count, size_t window, double* out) {
+    if (window == 0 || count < window) return;
+    dispatch().rollingMean(values, count, window, out);
+}
+
+void SeriesKernels::rollingMeanScalar(const double* values, size_t count, size_t window, double* out) {
+    if (window == 0 || count < window) return;
+    rollingMeanRange(values, window, out, count - window + 1);
+}
+
+SeriesKernels::WindowMeanFn SeriesKernels::fixedWindowMean(size_t window) {
+    for (const auto& kernel : FIXED_WINDOW_KERNELS) {
+        if (kernel.window == window) return dispatch().avx2 ? kernel.avx2 : kernel.scalar;
+    }
+    return nullptr;
+}
+
+void SeriesKernels::prefixSums(const double* values, size_t count, double* sums, double* errors) {
+    // The rounding error of each addition is recovered exactly (TwoSum) and
+    // accumulated on the side, so neither chain waits on the other
+    double sum = 0.0;
+    double error = 0.0;
+    sums[0] = errors[0] = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        double total = sum + values[i];
+        double part = total - sum;
+        error += (sum - (total - part)) + (values[i] - part);
+        sum = total;
+        sums[i + 1] = sum;
+        errors[i + 1] = error;
+    }
+}
+
+void SeriesKernels::windowMeans(const double* sums, const double* errors, size_t window, double* out, size_t outputs) {
+    dispatch().windowMeans(sums, errors, window, out, outputs);
+}
+
+void SeriesKernels::exponentialMeans(const double* values, size_t count, const double* alphas, size_t alphaCount,
+                                     size_t skip, double* out) {
+    if (count == 0 || skip >= count || alphaCount == 0) return;
+    dispatch().exponentialMeans(values, count, alphas, alphaCount, skip, out);
+}
+
+void SeriesKernels::priceChanges(const double* values, size_t count, double* gains, double* losses) {
+    dispatch().priceChanges(values, count, gains, losses);
+}
+
+void SeriesKernels::trueRanges(const double* highs, const double* lows, const double* previousCloses, size_t count,
+                               double* out) {
+    dispatch().trueRanges(highs, lows, previousCloses, count, out);
+}
+
+void SeriesKernels::relativeStrength(const double* averageGains, const double* averageLosses, size_t count,
+                                     double* out) {
+    dispatch().relativeStrength(averageGains, averageLosses, count, out);
+}
+
+void SeriesKernels::bands(const double* means, const double* variances, size_t count, double width, double* out) {
+    dispatch().bands(means, variances, count, width, out);
+}
+
+void SeriesKernels::linearRecurrence(const double* inputs, size_t count, double decay, double gain,
+                                     const double* powers, double& state, double* out) {
+    dispatch().linearRecurrence(inputs, count, decay, gain, powers, state, out);
+}
+
+void SeriesKernels::decayPowers(double decay, size_t count, double* powers) {
+    double power = 1.0;
+    for (size_t j = 0; j < count; ++j) {
+        powers[j] = power;
+        power *= decay;
+    }
+}
+
+const char* SeriesKernels::activeInstructionSet() {
+    return dispatch().name;
+}
@@ -0,0 +1,251 @@
+#include "../include/Snapshot.h"
+#include "../include/MappedFile.h"
+#include "../include/DateTime.h"
+#include "../include/Metrics.h"
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    const char MAGIC[8] = {'S', 'T', 'K', 'S', 'N', 'A', 'P', '\0'};
+
+    enum Column { OPEN, HIGH, LOW, CLOSE, VOLUME, TIMESTAMPS, DATE_OFFSETS, DATE_CHARS, COLUMN_COUNT };
+
+    // Version 1 header: the same fields up to the symbol, then seven column
+    // offsets (no timestamps) and the file size
+    constexpr uint32_t LEGACY_VERSION = 1;
+    constexpr size_t LEGACY_HEADER_SIZE = 128;
+    constexpr size_t LEGACY_OFFSETS_POSITION = 64;
+
+    // Keeps the mapping alive together with timestamps parsed at load
+    struct LegacyStorage {
+        std::shared_ptr<const MappedFile> file;
+        std::vector<int64_t> timestamps;
+    };
+
+    bool isLittleEndianHost() {
+        const uint16_t probe = 1;
+        unsigned char first;
+        std::memcpy(&first, &probe, 1);
+        return first == 1;
+    }
+
+    uint64_t alignUp(uint64_t value) {
+        const uint64_t mask = Snapshot::COLUMN_ALIGNMENT - 1;
+        return (value + mask) & ~mask;
+    }
+
+    void requireLittleEndian() {
+        if (!isLittleEndianHost()) {
+            throw std::runtime_error("Snapshots are only supported on little-endian hosts");
+        }
+    }
+
+    void writePadded(std::ofstream& out, const void* data, size_t size, uint64_t& position) {
+        static const char zeros[Snapshot::COLUMN_ALIGNMENT] = {};
+        uint64_t aligned = alignUp(position);
+        out.write(zeros, static_cast<std::streamsize>(aligned - position));
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        position = aligned + size;
+    }
+}
+
+void Snapshot::write(const PriceSeries& series, const std::string& path) {
+    requireLittleEndian();
+    if (series.getSymbol().size() >= sizeof(SnapshotHeader::symbol)) {
+        throw std::invalid_argument("Symbol too long for snapshot: " + series.getSymbol());
+    }
+
+    const uint64_t rows = series.size();
+    auto dateOffsets = series.getDateOffsets();
+    auto dateChars = series.getDateChars();
+    auto timestamps = series.getTimestamps();
+
+    // Slices carry offsets into their parent's characters; files start at 0
+    std::vector<uint32_t> rebased;
+    if (dateOffsets[0] != 0) {
+        rebased.assign(dateOffsets.begin(), dateOffsets.end());
+        for (auto& offset : rebased) offset -= dateOffsets[0];
+        dateOffsets = ColumnView<uint32_t>(rebased);
+    }
+    const ColumnView<double> priceColumns[] = {
+        series.getOpens(), series.getHighs(), series.getLows(),
+        series.getCloses(), series.getVolumes()
+    };
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.rowCount = rows;
+    header.dateCharsSize = dateChars.size();
+    std::memcpy(header.symbol, series.getSymbol().data(), series.getSymbol().size());
+
+    uint64_t position = sizeof(SnapshotHeader);
+    for (int column = OPEN; column <= VOLUME; ++column) {
+        header.columnOffsets[column] = alignUp(position);
+        position = header.columnOffsets[column] + rows * sizeof(double);
+    }
+    header.columnOffsets[TIMESTAMPS] = alignUp(position);
+    position = header.columnOffsets[TIMESTAMPS] + rows * sizeof(int64_t);
+    header.columnOffsets[DATE_OFFSETS] = alignUp(position);
+    position = header.columnOffsets[DATE_OFFSETS] + (rows + 1) * sizeof(uint32_t);
+    header.columnOffsets[DATE_CHARS] = alignUp(position);
+    header.fileSize = header.columnOffsets[DATE_CHARS] + dateChars.size();
+
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not create file: " + tempPath);
+        }
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        position = sizeof(SnapshotHeader);
+        for (const auto& column : priceColumns) {
+            writePadded(out, column.data(), rows * sizeof(double), position);
+        }
+        writePadded(out, timestamps.data(), rows * sizeof(int64_t), position);
+        writePadded(out, dateOffsets.data(), (rows + 1) * sizeof(uint32_t), position);
+        writePadded(out, dateChars.data(), dateChars.size(), position);
+
+        out.flush();
+        if (!out) {
+            std::remove(tempPath.c_str());
+            throw std::runtime_error("Could not write file: " + tempPath);
+        }
+    }
+
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        throw std::runtime_error("Could not replace file: " + path);
+    }
+}
+
+PriceSeries Snapshot::load(const std::string& path) {
+    Metrics::ScopedTimer timer(Metrics::Stage::SnapshotLoad);
+    requireLittleEndian();
+    auto file = std::make_shared<const MappedFile>(path);
+
+    // The fields up to the symbol are laid out the same in every version
+    SnapshotHeader header{};
+    if (file->size() < LEGACY_HEADER_SIZE) {
+        throw std::runtime_error("Truncated snapshot header: " + path);
+    }
+    std::memcpy(&header, file->data(), LEGACY_OFFSETS_POSITION);
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("Not a stock snapshot: " + path);
+    }
+    const bool legacy = header.version == LEGACY_VERSION;
+    if (legacy) {
+        // Same offsets, shifted past the missing timestamp column
+        const char* legacyOffsets = file->data() + LEGACY_OFFSETS_POSITION;
+        std::memcpy(header.columnOffsets, legacyOffsets, TIMESTAMPS * sizeof(uint64_t));
+        std::memcpy(header.columnOffsets + DATE_OFFSETS, legacyOffsets + TIMESTAMPS * sizeof(uint64_t),
+                    2 * sizeof(uint64_t));
+        std::memcpy(&header.fileSize, legacyOffsets + 7 * sizeof(uint64_t), sizeof(uint64_t));
+    } else if (header.version == FORMAT_VERSION) {
+        if (file->size() < sizeof(header)) {
+            throw std::runtime_error("Truncated snapshot header: " + path);
+        }
+        std::memcpy(&header, file->data(), sizeof(header));
+    } else {
+        throw std::runtime_error("Unsupported snapshot version " + std::to_string(header.version) + ": " + path);
+    }
+    const uint64_t headerSize = legacy ? LEGACY_HEADER_SIZE : sizeof(SnapshotHeader);
+    if (header.headerSize != headerSize || header.fileSize != file->size()) {
+        throw std::runtime_error("Corrupt snapshot header: " + path);
+    }
+    if (header.symbol[sizeof(header.symbol) - 1] != '\0') {
+        throw std::runtime_error("Corrupt snapshot symbol: " + path);
+    }
+
+    // Every column must be aligned and lie inside the file
+    const uint64_t rows = header.rowCount;
+    const uint64_t columnSizes[COLUMN_COUNT] = {
+        rows * sizeof(double), rows * sizeof(double), rows * sizeof(double),
+        rows * sizeof(double), rows * sizeof(double), rows * sizeof(int64_t),
+        (rows + 1) * sizeof(uint32_t), header.dateCharsSize
+    };
+    if (rows > file->size() / sizeof(double)) {
+        throw std::runtime_error("Corrupt snapshot row count: " + path);
+    }
+    for (int column = 0; column < COLUMN_COUNT; ++column) {
+        if (legacy && column == TIMESTAMPS) continue;
+        uint64_t offset = header.columnOffsets[column];
+        if (offset % COLUMN_ALIGNMENT != 0 || offset < headerSize ||
+            offset > file->size() || columnSizes[column] > file->size() - offset) {
+            throw std::runtime_error("Corrupt snapshot column layout: " + path);
+        }
+    }
+
+    const char* base = file->data();
+    PriceSeries::ExternalColumns columns;
+    columns.rows = rows;
+    columns.opens = reinterpret_cast<const double*>(base + header.columnOffsets[OPEN]);
+    columns.highs = reinterpret_cast<const double*>(base + header.columnOffsets[HIGH]);
+    columns.lows = reinterpret_cast<const double*>(base + header.columnOffsets[LOW]);
+    columns.closes = reinterpret_cast<const double*>(base + header.columnOffsets[CLOSE]);
+    columns.volumes = reinterpret_cast<const double*>(base + header.columnOffsets[VOLUME]);
+    columns.dateOffsets = reinterpret_cast<const uint32_t*>(base + header.columnOffsets[DATE_OFFSETS]);
+    columns.dateChars = base + header.columnOffsets[DATE_CHARS];
+
+    // One pass over 12 bytes per row; keeps a damaged file from sending
+    // getDate outside the mapping or breaking range lookups
+    if (columns.dateOffsets[0] != 0 || columns.dateOffsets[rows] != header.dateCharsSize) {
+        throw std::runtime_error("Corrupt snapshot date column: " + path);
+    }
+    for (uint64_t i = 0; i < rows; ++i) {
+        if (columns.dateOffsets[i + 1] < columns.dateOffsets[i]) {
+            throw std::runtime_error("Corrupt snapshot date column at row " + std::to_string(i) + ": " + path);
+        }
+    }
+
+    std::shared_ptr<const void> owner = file;
+    if (legacy) {
+        auto legacyStorage = std::make_shared<LegacyStorage>();
+        legacyStorage->file = file;
+        legacyStorage->timestamps.resize(rows);
+        for (uint64_t i = 0; i < rows; ++i) {
+            std::string_view date(columns.dateChars + columns.dateOffsets[i],
+                                  columns.dateOffsets[i + 1] - columns.dateOffsets[i]);
+            if (!DateTime::parse(date, legacyStorage->timestamps[i])) {
+                throw std::runtime_error("Invalid snapshot date at row " + std::to_string(i) + ": " + path);
+            }
+        }
+        columns.timestamps = legacyStorage->timestamps.data();
+        owner = std::move(legacyStorage);
+    } else {
+        columns.timestamps = reinterpret_cast<const int64_t*>(base + header.columnOffsets[TIMESTAMPS]);
+    }
+    for (uint64_t i = 1; i < rows; ++i) {
+        if (columns.timestamps[i] <= columns.timestamps[i - 1]) {
+            throw std::runtime_error("Snapshot dates are not increasing at row " + std::to_string(i) + ": " + path);
+        }
+    }
+
+    size_t bytes = file->size() + (legacy ? rows * sizeof(int64_t) : 0);
+    return PriceSeries(std::string(header.symbol), columns, std::move(owner), bytes);
+}
+
+PriceSeries Snapshot::verify(const std::string& path) {
+    PriceSeries series = load(path);
+    const char* names[] = {"Open", "High", "Low", "Close", "Volume"};
+    const ColumnView<double> priceColumns[] = {
+        series.getOpens(), series.getHighs(), series.getLows(),
+        series.getCloses(), series.getVolumes()
+    };
+    for (size_t column = 0; column < 5; ++column) {
+        for (size_t i = 0; i < series.size(); ++i) {
+            if (!std::isfinite(priceColumns[column][i])) {
+                throw std::runtime_error("Non-finite " + std::string(names[column]) +
+                                         " value at row " + std::to_string(i) + ": " + path);
+            }
+        }
+    }
+    return series;
+}
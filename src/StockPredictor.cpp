@@ -1,34 +1,533 @@
 #include "../include/StockPredictor.h"
+#include "../include/Log.h"
+#include "../include/Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
 
-StockPredictor::StockPredictor(const std::string& dataDir) 
-    : fileHandler(std::make_unique<FileHandler>(dataDir)) {
+namespace {
+    // Budget of each of the two prediction caches
+    size_t predictionCacheBytes(size_t cacheBudgetBytes, size_t percent) {
+        if (percent > 100) {
+            throw std::invalid_argument("Prediction cache share must be between 0 and 100 percent");
+        }
+        return cacheBudgetBytes * percent / 200;
+    }
+}
+
+StockPredictor::StockPredictor(const std::string& dataDir, size_t cacheBudgetBytes, size_t batchThreads,
+                               size_t predictionCachePercent)
+    : fileHandler(std::make_unique<FileHandler>(dataDir)),
+      seriesCache(cacheBudgetBytes - 2 * predictionCacheBytes(cacheBudgetBytes, predictionCachePercent)),
+      algorithms(std::make_shared<const AlgorithmMap>()),
+      scheduler(std::make_unique<TaskScheduler>(batchThreads)),
+      liveSeries(predictionCacheBytes(cacheBudgetBytes, predictionCachePercent)),
+      resultCache(predictionCacheBytes(cacheBudgetBytes, predictionCachePercent)),
+      predictionWriter(std::make_unique<PredictionWriter>(*fileHandler)) {
     initializeAlgorithms();
 }
 
+StockPredictor::~StockPredictor() {
+    stopWarmup.store(true);
+    if (warmupThread.joinable()) warmupThread.join();
+    // The cache outlives the registry its reservations point into
+    seriesCache.clear();
+}
+
+void StockPredictor::startWarmup(size_t memoryCapBytes) {
+    if (warmupThread.joinable()) {
+        throw std::logic_error("Warm-up has already been started");
+    }
+    // Series past the cache budget would only evict each other
+    registry.beginWarmup(std::min(memoryCapBytes, seriesCache.getStats().capacityBytes));
+    warmupThread = std::thread([this] { warmUp(); });
+}
+
+void StockPredictor::warmUp() {
+    std::vector<std::string> symbols;
+    try {
+        symbols = fileHandler->listSymbols();
+    } catch (const std::exception& e) {
+        LOG_ERROR("Warm-up could not list " << fileHandler->getDataDirectory() << ": " << e.what());
+    }
+    registry.beginLoading(symbols.size());
+
+    scheduler->parallelFor(symbols.size(), [&](size_t i) {
+        if (stopWarmup.load(std::memory_order_relaxed)) return;
+        const std::string& symbol = symbols[i];
+        SymbolInfo info;
+        try {
+            FileVersion version = fileHandler->getFileVersion(symbol);
+            auto series = std::make_shared<const PriceSeries>(fileHandler->readStockData(symbol));
+            info = describe(symbol, version, *series);
+            if (auto reservation = registry.reserveResident(info.memoryBytes)) {
+                seriesCache.put(symbol, CachedSeries{version, series, std::move(reservation)}, info.memoryBytes);
+            }
+        } catch (const std::exception& e) {
+            info.symbol = symbol;
+            info.error = e.what();
+        }
+        registry.warmed(std::move(info));
+    });
+    registry.finishWarmup();
+
+    WarmupProgress progress = registry.getProgress();
+    LOG_INFO("Warm-up finished: " << progress.symbolsDone << " symbols indexed, " << progress.symbolsResident
+             << " cached (" << progress.residentBytes / (1024 * 1024) << " MB), " << progress.symbolsFailed
+             << " failed in " << progress.elapsedMs << " ms");
+}
+
+SymbolInfo StockPredictor::describe(const std::string& symbol, const FileVersion& version, const PriceSeries& series) {
+    SymbolInfo info;
+    info.symbol = symbol;
+    info.version = version;
+    info.rows = series.size();
+    info.memoryBytes = series.memoryUsage();
+    if (!series.empty()) {
+        auto timestamps = series.getTimestamps();
+        info.firstTimestamp = timestamps[0];
+        info.lastTimestamp = timestamps[series.size() - 1];
+    }
+    return info;
+}
+
 void StockPredictor::initializeAlgorithms() {
     registerAlgorithm("SMA", std::make_unique<MovingAverageAlgorithm>(5));
     registerAlgorithm("EMA", std::make_unique<ExponentialMovingAverageAlgorithm>(0.2));
+    registerAlgorithm("WMA", std::make_unique<WeightedMovingAverageAlgorithm>(10));
+    registerAlgorithm("BOLLINGER", std::make_unique<BollingerBandsAlgorithm>(20, 2.0, "middle"));
+    registerAlgorithm("RSI", std::make_unique<RelativeStrengthIndexAlgorithm>(14));
+    registerAlgorithm("MACD", std::make_unique<MacdAlgorithm>(12, 26, 9, "macd"));
+    registerAlgorithm("ATR", std::make_unique<AverageTrueRangeAlgorithm>(14));
 }
 
-std::vector<StockData> StockPredictor::getHistoricalData(const std::string& symbol) {
-    return fileHandler->readStockData(symbol);
+std::shared_ptr<const PriceSeries> StockPredictor::getHistoricalData(const std::string& symbol) {
+    FileVersion version;
+    return loadSeries(symbol, version);
 }
 
-std::vector<double> StockPredictor::predict(const std::string& symbol, const std::string& algorithm) {
-    auto it = algorithms.find(algorithm);
-    if (it == algorithms.end()) {
-        throw std::runtime_error("Unknown algorithm: " + algorithm);
+std::shared_ptr<const PriceSeries> StockPredictor::loadSeries(const std::string& symbol, FileVersion& version) {
+    // Stat before parsing: a write racing with the parse then only costs a
+    // re-parse on the next request instead of pinning stale data
+    version = fileHandler->getFileVersion(symbol);
+
+    auto cached = seriesCache.get(symbol, [&version](const CachedSeries& entry) {
+        return entry.version == version;
+    });
+    if (cached) {
+        return cached->series;
     }
 
-    auto data = getHistoricalData(symbol);
-    auto predictions = it->second->predict(data);
-    fileHandler->writePredictions(symbol, predictions);
-    return predictions;
+    auto series = std::make_shared<const PriceSeries>(fileHandler->readStockData(symbol));
+    seriesCache.put(symbol, CachedSeries{version, series, nullptr}, series->memoryUsage());
+    registry.update(describe(symbol, version, *series));
+    return series;
+}
+
+PredictionWindow StockPredictor::predict(const std::string& symbol, const std::string& algorithm,
+                                         const nlohmann::json& params, bool persist) {
+    auto algo = getAlgorithm(algorithm, params);
+    std::string key = predictionKey(symbol, algorithm, *algo);
+    std::shared_ptr<const std::vector<double>> predictions;
+
+    // Loaded first, so a cached or live result is only used when it matches
+    // the version of this snapshot, and the snapshot can go with it to the
+    // caller and to disk
+    FileVersion current;
+    auto data = loadSeries(symbol, current);
+
+    // Exact result for this data version
+    if (auto cached = resultCache.get(key + '\n' + versionString(current))) {
+        predictions = *cached;
+    }
+
+    // Live series that already absorbed the latest appends
+    if (!predictions) {
+        if (auto live = liveSeries.get(key)) {
+            std::unique_lock<std::mutex> lock((*live)->mutex);
+            if ((*live)->version == current) {
+                predictions = std::make_shared<const std::vector<double>>((*live)->predictions);
+                lock.unlock();
+                cacheResult(key, current, predictions);
+            }
+        }
+    }
+
+    if (!predictions) {
+        predictions = std::make_shared<const std::vector<double>>(compute(*algo, *data));
+        cacheResult(key, current, predictions);
+
+        if (auto state = algo->createOnlineState()) {
+            auto live = std::make_shared<LiveSeries>();
+            state->seed(data->getCloses(), *predictions);
+            live->state = std::move(state);
+            live->predictions = *predictions;
+            live->version = current;
+            liveSeries.put(key, live, predictions->size() * sizeof(double) + sizeof(LiveSeries));
+            registerLiveSeries(symbol, live);
+        }
+    }
+
+    if (persist) {
+        predictionWriter->enqueue(symbol, data, algo->getLookback(), predictions);
+    }
+
+    PredictionWindow window;
+    window.series = std::move(data);
+    window.firstBar = algo->getLookback();
+    window.predictions = *predictions;
+    return window;
+}
+
+PredictionWindow StockPredictor::predictRange(const std::string& symbol, const std::string& algorithm,
+                                              const nlohmann::json& params, int64_t from, int64_t to) {
+    auto algo = getAlgorithm(algorithm, params);
+    PredictionWindow window;
+    window.series = getHistoricalData(symbol);
+
+    size_t begin = window.series->lowerBound(from);
+    size_t end = std::max(begin, window.series->lowerBound(to));
+    window.firstBar = begin;
+    if (begin == end) return window;
+
+    // Start early enough that the first requested bar sees its full history
+    size_t warmup = std::max(algo->getWarmup(), algo->getLookback());
+    size_t start = begin > warmup ? begin - warmup : 0;
+    if (end - start <= algo->getLookback()) {
+        // Too little history for even one prediction in the range
+        window.firstBar = end;
+        return window;
+    }
+    auto values = compute(*algo, PriceSeries::slice(window.series, start, end));
+
+    // values[i] belongs to bar start + lookback + i; drop the warm-up part
+    size_t firstComputed = start + algo->getLookback();
+    size_t skip = begin > firstComputed ? begin - firstComputed : 0;
+    window.firstBar = std::max(begin, firstComputed);
+    if (skip < values.size()) {
+        window.predictions.assign(values.begin() + static_cast<std::ptrdiff_t>(skip), values.end());
+    }
+    return window;
+}
+
+std::string StockPredictor::getDataTag(const std::string& symbol) {
+    return makeETag(symbol + '\n' + versionString(fileHandler->getFileVersion(symbol)));
+}
+
+std::string StockPredictor::getPredictionTag(const std::string& symbol, const std::string& algorithm,
+                                             const nlohmann::json& params, const std::string& variant) {
+    auto algo = getAlgorithm(algorithm, params);
+    return makeETag(predictionKey(symbol, algorithm, *algo) + '\n' +
+                    versionString(fileHandler->getFileVersion(symbol)) + '\n' + variant);
+}
+
+std::string StockPredictor::predictionKey(const std::string& symbol, const std::string& algorithm,
+                                          const PredictionAlgorithm& algo) {
+    // getParameters() is canonical: omitted and explicit defaults give the same key
+    return symbol + '\n' + algorithm + '\n' + algo.getParameters().dump();
+}
+
+std::string StockPredictor::versionString(const FileVersion& version) {
+    return std::to_string(version.modifiedTime) + ':' + std::to_string(version.size);
+}
+
+std::string StockPredictor::makeETag(const std::string& key) {
+    // 64-bit FNV-1a over the full key
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    char buffer[20];
+    std::snprintf(buffer, sizeof(buffer), "\"%016llx\"", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+void StockPredictor::cacheResult(const std::string& key, const FileVersion& version,
+                                 const std::shared_ptr<const std::vector<double>>& predictions) {
+    resultCache.put(key + '\n' + versionString(version), predictions,
+                    predictions->size() * sizeof(double) + key.size());
+}
+
+std::vector<double> StockPredictor::predict(const PriceSeries& data, const std::string& algorithm,
+                                            const nlohmann::json& params) const {
+    return compute(*getAlgorithm(algorithm, params), data);
+}
+
+std::vector<double> StockPredictor::compute(const PredictionAlgorithm& algo, const PriceSeries& data) {
+    Metrics::ScopedTimer timer(Metrics::Stage::AlgorithmCompute);
+    Metrics::add(Metrics::Counter::AlgorithmRows, data.size());
+    return algo.predict(data);
+}
+
+void StockPredictor::computeIndicators(const std::vector<const Indicator*>& indicators, const PriceSeries& data,
+                                       const std::vector<std::vector<double>*>& outputs) {
+    Metrics::ScopedTimer timer(Metrics::Stage::AlgorithmCompute);
+    Metrics::add(Metrics::Counter::AlgorithmRows, data.size());
+    IndicatorEngine::run(data, indicators, outputs);
+}
+
+void StockPredictor::registerLiveSeries(const std::string& symbol, const std::shared_ptr<LiveSeries>& live) {
+    std::lock_guard<std::mutex> lock(liveIndexMutex);
+    auto& entries = liveBySymbol[symbol];
+    // Drop series that were evicted or replaced
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [](const std::weak_ptr<LiveSeries>& entry) { return entry.expired(); }),
+                  entries.end());
+    entries.push_back(live);
+}
+
+size_t StockPredictor::appendBars(const std::string& symbol, const PriceSeries& bars) {
+    if (bars.empty()) return 0;
+
+    std::shared_ptr<std::mutex> appendLock;
+    {
+        std::lock_guard<std::mutex> lock(appendLocksMutex);
+        auto& slot = appendLocks[symbol];
+        if (!slot) slot = std::make_shared<std::mutex>();
+        appendLock = slot;
+    }
+    std::lock_guard<std::mutex> appendGuard(*appendLock);
+
+    FileVersion before;
+    auto existing = loadSeries(symbol, before);
+    if (!existing->empty() && bars.getTimestamps().front() <= existing->getTimestamps().back()) {
+        throw std::invalid_argument("Bar dated " + std::string(bars.getDate(0)) +
+                                    " is not after the last stored bar (" +
+                                    std::string(existing->getDate(existing->size() - 1)) + ")");
+    }
+    fileHandler->appendStockData(symbol, bars);
+    FileVersion after = fileHandler->getFileVersion(symbol);
+    // Live series move only to a version that holds the bars they are fed
+    if (after == before) return 0;
+
+    std::vector<std::shared_ptr<LiveSeries>> targets;
+    {
+        std::lock_guard<std::mutex> lock(liveIndexMutex);
+        auto it = liveBySymbol.find(symbol);
+        if (it != liveBySymbol.end()) {
+            for (const auto& entry : it->second) {
+                if (auto live = entry.lock()) targets.push_back(std::move(live));
+            }
+        }
+    }
+
+    size_t updated = 0;
+    auto closes = bars.getCloses();
+    for (const auto& live : targets) {
+        std::lock_guard<std::mutex> lock(live->mutex);
+        // A series that missed an earlier change is recomputed on its next read
+        if (live->version != before) continue;
+
+        double prediction;
+        for (double close : closes) {
+            if (live->state->update(close, prediction)) {
+                live->predictions.push_back(prediction);
+            }
+        }
+        live->version = after;
+        ++updated;
+    }
+    return updated;
+}
+
+void StockPredictor::predictBatch(const std::vector<std::string>& symbols,
+                                  const std::vector<AlgorithmSpec>& specs,
+                                  const BatchCallback& onResult, bool persist) {
+    // Resolve (and validate) every algorithm once, up front
+    std::vector<std::shared_ptr<const PredictionAlgorithm>> resolved;
+    resolved.reserve(specs.size());
+    for (const auto& spec : specs) {
+        resolved.push_back(getAlgorithm(spec.name, spec.parameters));
+    }
+
+    std::atomic<bool> cancelled{false};
+    scheduler->parallelFor(symbols.size(), [&](size_t index) {
+        if (cancelled.load(std::memory_order_relaxed)) return;
+
+        auto start = std::chrono::steady_clock::now();
+        BatchSymbolResult result;
+        result.index = index;
+        result.symbol = symbols[index];
+        try {
+            auto data = getHistoricalData(result.symbol);
+            result.series = data;
+            result.results.resize(resolved.size());
+
+            // Indicators share one fused pass over the series; the other
+            // algorithms run one at a time
+            std::vector<const Indicator*> indicators;
+            std::vector<std::vector<double>*> outputs;
+            for (size_t i = 0; i < resolved.size(); ++i) {
+                BatchPrediction& prediction = result.results[i];
+                prediction.algorithm = specs[i].name;
+                try {
+                    if (auto indicator = dynamic_cast<const Indicator*>(resolved[i].get())) {
+                        indicator->checkLength(*data);
+                        indicators.push_back(indicator);
+                        outputs.push_back(&prediction.predictions);
+                    } else {
+                        prediction.predictions = compute(*resolved[i], *data);
+                    }
+                } catch (const std::exception& e) {
+                    prediction.error = e.what();
+                }
+            }
+            if (!indicators.empty()) {
+                computeIndicators(indicators, *data, outputs);
+            }
+
+            for (size_t i = 0; persist && i < resolved.size(); ++i) {
+                if (!result.results[i].error.empty()) continue;
+                predictionWriter->enqueue(
+                    result.symbol, data, resolved[i]->getLookback(),
+                    std::make_shared<const std::vector<double>>(result.results[i].predictions));
+            }
+        } catch (const std::exception& e) {
+            result.error = e.what();
+        }
+        result.elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        if (!onResult(std::move(result))) {
+            cancelled.store(true, std::memory_order_relaxed);
+        }
+    });
+}
+
+std::vector<BatchPrediction> StockPredictor::analyze(const std::shared_ptr<const PriceSeries>& data,
+                                                    const std::vector<AlgorithmSpec>& specs, size_t limit) {
+    std::vector<BatchPrediction> results(specs.size());
+    std::vector<std::shared_ptr<const PredictionAlgorithm>> resolved(specs.size());
+    size_t rows = 0;
+    for (size_t i = 0; i < specs.size(); ++i) {
+        results[i].algorithm = specs[i].name;
+        try {
+            resolved[i] = getAlgorithm(specs[i].name, specs[i].parameters);
+            rows = std::max(rows, resolved[i]->getLookback() + limit);
+        } catch (const std::exception& e) {
+            results[i].error = e.what();
+        }
+    }
+
+    // Predictions only look back, so the first limit of every algorithm
+    // depend on the first lookback + limit bars alone
+    std::shared_ptr<const PriceSeries> input = data;
+    if (limit > 0 && rows < data->size()) {
+        input = std::make_shared<const PriceSeries>(PriceSeries::slice(data, 0, rows));
+    }
+
+    // The plan: each stand-alone algorithm on its own, then all the
+    // indicators together
+    std::vector<size_t> standalone;
+    std::vector<const Indicator*> indicators;
+    std::vector<std::vector<double>*> outputs;
+    for (size_t i = 0; i < specs.size(); ++i) {
+        if (!resolved[i]) continue;
+        auto indicator = dynamic_cast<const Indicator*>(resolved[i].get());
+        if (!indicator) {
+            standalone.push_back(i);
+            continue;
+        }
+        try {
+            indicator->checkLength(*input);
+            indicators.push_back(indicator);
+            outputs.push_back(&results[i].predictions);
+        } catch (const std::exception& e) {
+            results[i].error = e.what();
+        }
+    }
+
+    // The trimmed series is at most lookback + limit bars, too short for
+    // fanning the plan out over the scheduler to pay off
+    for (size_t index : standalone) {
+        try {
+            results[index].predictions = compute(*resolved[index], *input);
+        } catch (const std::exception& e) {
+            results[index].error = e.what();
+        }
+    }
+    if (!indicators.empty()) {
+        computeIndicators(indicators, *input, outputs);
+    }
+
+    if (limit > 0) {
+        for (auto& result : results) {
+            if (result.predictions.size() > limit) result.predictions.resize(limit);
+        }
+    }
+    return results;
+}
+
+std::vector<BacktestRun> StockPredictor::backtest(const std::vector<std::string>& symbols,
+                                                  const std::vector<AlgorithmSpec>& specs,
+                                                  const BacktestWindow& window) {
+    std::vector<std::shared_ptr<const PredictionAlgorithm>> resolved;
+    resolved.reserve(specs.size());
+    for (const auto& spec : specs) {
+        resolved.push_back(getAlgorithm(spec.name, spec.parameters));
+    }
+
+    // Load each symbol once, so runs sharing a symbol never race to parse it
+    std::vector<std::shared_ptr<const PriceSeries>> series(symbols.size());
+    std::vector<std::string> loadErrors(symbols.size());
+    scheduler->parallelFor(symbols.size(), [&](size_t index) {
+        try {
+            series[index] = getHistoricalData(symbols[index]);
+        } catch (const std::exception& e) {
+            loadErrors[index] = e.what();
+        }
+    });
+
+    std::vector<BacktestRun> runs(symbols.size() * specs.size());
+    scheduler->parallelFor(runs.size(), [&](size_t index) {
+        // One buffer per worker thread, grown to its longest series and reused
+        thread_local std::vector<double> scratch;
+
+        size_t symbol = index / specs.size();
+        BacktestRun& run = runs[index];
+        if (!series[symbol]) {
+            run.error = loadErrors[symbol];
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        try {
+            run.metrics = Backtester::evaluate(*resolved[index % specs.size()], series[symbol], window, scratch);
+        } catch (const std::exception& e) {
+            run.error = e.what();
+        }
+        run.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    });
+    return runs;
+}
+
+SweepResult StockPredictor::sweep(const std::string& symbol, std::vector<int> windows, std::vector<double> alphas,
+                                  int64_t from, int64_t to) {
+    auto series = getHistoricalData(symbol);
+    size_t begin = series->lowerBound(from);
+    size_t end = std::max(begin, series->lowerBound(to));
+    return ParameterSweep::run(std::move(series), std::move(windows), std::move(alphas), begin, end);
+}
+
+std::shared_ptr<const PredictionAlgorithm> StockPredictor::getAlgorithm(const std::string& name,
+                                                                        const nlohmann::json& params) const {
+    auto registry = std::atomic_load(&algorithms);
+    auto it = registry->find(name);
+    if (it == registry->end()) {
+        throw std::runtime_error("Unknown algorithm: " + name);
+    }
+    if (params.is_null()) {
+        return it->second;
+    }
+    return it->second->withParameters(params);
 }
 
 std::vector<std::string> StockPredictor::getAvailableAlgorithms() const {
+    auto registry = std::atomic_load(&algorithms);
     std::vector<std::string> result;
-    for (const auto& algo : algorithms) {
+    for (const auto& algo : *registry) {
         result.push_back(algo.first);
     }
     return result;
@@ -40,5 +539,8 @@ std::string StockPredictor::getDataDirectory() const {
 
 void StockPredictor::registerAlgorithm(const std::string& name, 
                                      std::unique_ptr<PredictionAlgorithm> algorithm) {
-    algorithms[name] = std::move(algorithm);
+    std::lock_guard<std::mutex> lock(registryWriteMutex);
+    auto updated = std::make_shared<AlgorithmMap>(*std::atomic_load(&algorithms));
+    (*updated)[name] = std::shared_ptr<const PredictionAlgorithm>(std::move(algorithm));
+    std::atomic_store(&algorithms, std::shared_ptr<const AlgorithmMap>(std::move(updated)));
 }
\ No newline at end of file
@@ -0,0 +1,1588 @@
+#include "../include/StockServer.h"
+#include "../include/BinaryWriter.h"
+#include "../include/ColumnFrame.h"
+#include "../include/Compression.h"
+#include "../include/CsvParser.h"
+#include "../include/DateTime.h"
+#include "../include/JsonWriter.h"
+#include "../include/Log.h"
+#include "../include/RequestArena.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+using json = nlohmann::json;
+
+namespace {
+    constexpr size_t MAX_REPORTED_ROW_ERRORS = 20;
+    // Upper bound on symbols x parameter settings in one backtest request
+    constexpr size_t MAX_BACKTEST_RUNS = 100000;
+    // Streamed responses are handed to the socket in chunks of about this size
+    constexpr size_t STREAM_CHUNK_BYTES = 64 * 1024;
+
+    // Rows [begin, end) of a series selected by from/to/cursor/limit
+    struct RowRange {
+        size_t begin = 0;
+        size_t end = 0;
+        bool truncated = false;  // limit cut the range short; end is the next cursor
+    };
+
+    size_t parseCount(const httplib::Request& req, const char* name) {
+        std::string text = req.get_param_value(name);
+        size_t count = 0;
+        auto result = std::from_chars(text.data(), text.data() + text.size(), count);
+        if (text.empty() || result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+            throw std::invalid_argument(std::string("Invalid '") + name + "' parameter: " + text);
+        }
+        return count;
+    }
+
+    // Start of from's period or end of to's period in epoch seconds, so
+    // "2024-03" as `to` includes all of March
+    int64_t periodBound(const std::string& text, bool upper) {
+        int64_t start, end;
+        if (!DateTime::parsePeriod(text, start, end)) {
+            throw std::invalid_argument("Invalid date: " + text);
+        }
+        return upper ? end : start;
+    }
+
+    // Dates of the bars the predictions belong to; null past the last bar
+    template <typename Writer>
+    void writeAlignedDates(Writer& writer, const PriceSeries& series, size_t firstBar, size_t count) {
+        writer.beginArray(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (firstBar + i < series.size()) writer.value(series.getDate(firstBar + i));
+            else writer.null();
+        }
+        writer.endArray();
+    }
+
+    // The /api/predict document, through either writer
+    template <typename Writer>
+    void writePrediction(Writer& writer, const std::string& symbol, const std::string& algorithm,
+                         const PredictionWindow& window) {
+        size_t count = window.predictions.size();
+        writer.beginObject(4)
+            .key("symbol").value(symbol)
+            .key("algorithm").value(algorithm)
+            .key("dates");
+        writeAlignedDates(writer, *window.series, window.firstBar, count);
+        writer.key("predictions").beginArray(count);
+        for (double prediction : window.predictions) {
+            writer.value(prediction);
+        }
+        writer.endArray().endObject();
+    }
+
+    RowRange selectRows(const httplib::Request& req, const PriceSeries& data) {
+        RowRange range{0, data.size(), false};
+        if (req.has_param("from")) range.begin = data.lowerBound(periodBound(req.get_param_value("from"), false));
+        if (req.has_param("to")) range.end = data.lowerBound(periodBound(req.get_param_value("to"), true));
+        if (req.has_param("cursor")) {
+            // A cursor is the row index where the previous page stopped
+            size_t cursor = parseCount(req, "cursor");
+            if (cursor > data.size()) {
+                throw std::invalid_argument("Cursor is past the end of the data");
+            }
+            range.begin = std::max(range.begin, cursor);
+        }
+        range.end = std::max(range.end, range.begin);
+        if (req.has_param("limit")) {
+            size_t limit = parseCount(req, "limit");
+            if (limit == 0) {
+                throw std::invalid_argument("'limit' must be positive");
+            }
+            if (range.end - range.begin > limit) {
+                range.end = range.begin + limit;
+                range.truncated = true;
+            }
+        }
+        return range;
+    }
+
+    // Response body encodings a client can choose with Accept; JSON is the default
+    enum class Encoding { Json, Cbor, MsgPack, Float64Columns, Float32Columns };
+
+    constexpr const char* COLUMNS_TYPE = "application/vnd.stock.columns";
+
+    std::string trimLower(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t");
+        if (first == std::string::npos) return "";
+        size_t last = text.find_last_not_of(" \t");
+        std::string out = text.substr(first, last - first + 1);
+        for (char& c : out) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return out;
+    }
+
+    // The supported type with the highest q in Accept, the earliest on a tie.
+    // Wildcards count as JSON; an Accept naming nothing supported gets JSON.
+    Encoding negotiateEncoding(const httplib::Request& req) {
+        if (!req.has_header("Accept")) return Encoding::Json;
+        std::string header = req.get_header_value("Accept");
+
+        Encoding best = Encoding::Json;
+        double bestQuality = 0.0;
+        size_t pos = 0;
+        while (pos < header.size()) {
+            size_t end = header.find(',', pos);
+            if (end == std::string::npos) end = header.size();
+            std::string range = header.substr(pos, end - pos);
+            pos = end + 1;
+
+            size_t paramsAt = range.find(';');
+            std::string type = trimLower(range.substr(0, paramsAt));
+            double quality = 1.0;
+            std::string dtype = "float64";
+            while (paramsAt != std::string::npos) {
+                size_t next = range.find(';', paramsAt + 1);
+                std::string param = range.substr(paramsAt + 1, next == std::string::npos ? std::string::npos
+                                                                                            : next - paramsAt - 1);
+                size_t equals = param.find('=');
+                if (equals != std::string::npos) {
+                    std::string name = trimLower(param.substr(0, equals));
+                    std::string value = trimLower(param.substr(equals + 1));
+                    if (name == "q") quality = std::strtod(value.c_str(), nullptr);
+                    else if (name == "dtype") dtype = value;
+                }
+                paramsAt = next;
+            }
+
+            Encoding encoding;
+            if (type == "application/json" || type == "application/*" || type == "*/*") {
+                encoding = Encoding::Json;
+            } else if (type == "application/cbor") {
+                encoding = Encoding::Cbor;
+            } else if (type == "application/msgpack" || type == "application/x-msgpack" ||
+                       type == "application/vnd.msgpack") {
+                encoding = Encoding::MsgPack;
+            } else if (type == COLUMNS_TYPE && (dtype == "float64" || dtype == "float32")) {
+                encoding = dtype == "float64" ? Encoding::Float64Columns : Encoding::Float32Columns;
+            } else {
+                continue;
+            }
+            if (quality > bestQuality) {
+                best = encoding;
+                bestQuality = quality;
+            }
+        }
+        return best;
+    }
+
+    std::string contentType(Encoding encoding) {
+        switch (encoding) {
+            case Encoding::Cbor: return "application/cbor";
+            case Encoding::MsgPack: return "application/msgpack";
+            case Encoding::Float64Columns: return std::string(COLUMNS_TYPE) + "; dtype=float64";
+            case Encoding::Float32Columns: return std::string(COLUMNS_TYPE) + "; dtype=float32";
+            default: return "application/json";
+        }
+    }
+
+    uint8_t columnValueBytes(Encoding encoding) {
+        return encoding == Encoding::Float32Columns ? 4 : 8;
+    }
+
+    bool isColumns(Encoding encoding) {
+        return encoding == Encoding::Float64Columns || encoding == Encoding::Float32Columns;
+    }
+
+    BinaryWriter::Format binaryFormat(Encoding encoding) {
+        return encoding == Encoding::Cbor ? BinaryWriter::Format::Cbor : BinaryWriter::Format::MsgPack;
+    }
+
+    // Each encoding is its own representation, so it needs its own ETag
+    std::string representationTag(const std::string& etag, Encoding encoding) {
+        static const char* const suffixes[] = {"", "-cbor", "-msgpack", "-f64", "-f32"};
+        if (encoding == Encoding::Json) return etag;
+        // Tags are quoted: the suffix goes inside the quotes
+        return etag.substr(0, etag.size() - 1) + suffixes[static_cast<int>(encoding)] + '"';
+    }
+
+    // Timestamps of the bars the predictions belong to; NO_TIMESTAMP past the last bar
+    void appendAlignedTimestamps(std::pmr::string& out, const PriceSeries& series, size_t firstBar, size_t count) {
+        size_t known = firstBar < series.size() ? std::min(count, series.size() - firstBar) : 0;
+        // firstBar may be past the end, where data() + firstBar is not a valid pointer
+        if (known > 0) ColumnFrame::appendTimestamps(out, series.getTimestamps().data() + firstBar, known);
+        for (size_t i = known; i < count; ++i) {
+            ColumnFrame::appendTimestamps(out, &ColumnFrame::NO_TIMESTAMP, 1);
+        }
+    }
+
+    // One frame holding a single "prediction" column
+    void appendPredictionFrame(std::pmr::string& out, Encoding encoding, json metadata, const PriceSeries& series,
+                               size_t firstBar, const std::vector<double>& predictions) {
+        metadata["columns"] = {"prediction"};
+        ColumnFrame::appendHeader(out, columnValueBytes(encoding), 1, predictions.size(), metadata.dump());
+        appendAlignedTimestamps(out, series, firstBar, predictions.size());
+        ColumnFrame::appendValues(out, columnValueBytes(encoding), predictions.data(), predictions.size());
+    }
+
+    // A frame with no rows, carrying only metadata (errors, timing)
+    void appendMetadataFrame(std::pmr::string& out, const json& metadata) {
+        ColumnFrame::appendHeader(out, 8, 0, 0, metadata.dump());
+    }
+
+    // Sends a response through the chunked provider, one chunk at a time, so
+    // memory stays flat however long the series is. fill points chunk at
+    // the next piece (about STREAM_CHUNK_BYTES) and returns true with the last.
+    template <typename Fill>
+    void streamChunks(httplib::Response& res, Metrics::Route route, const std::string& type, Fill fill) {
+        auto serializeNs = std::make_shared<uint64_t>(0);
+        res.set_chunked_content_provider(type,
+            [route, fill, serializeNs](size_t, httplib::DataSink& sink) {
+                auto start = std::chrono::steady_clock::now();
+                std::string_view chunk;
+                bool finished = fill(chunk);
+                *serializeNs += Metrics::elapsedSince(start);
+
+                if (!sink.write(chunk.data(), chunk.size())) return false;
+                Metrics::addBytesOut(route, chunk.size());
+                if (finished) {
+                    // One sample per response, however many chunks it took
+                    Metrics::recordStage(Metrics::Stage::JsonSerialize, *serializeNs);
+                    sink.done();
+                }
+                return true;
+            });
+    }
+
+    // Rows as an array of objects, in JSON, CBOR or MessagePack
+    void streamRows(httplib::Response& res, std::shared_ptr<const PriceSeries> data, RowRange range,
+                    Encoding encoding) {
+        auto next = std::make_shared<size_t>(range.begin);
+        auto writeRows = [data, range, next](auto& writer) {
+            auto opens = data->getOpens();
+            auto highs = data->getHighs();
+            auto lows = data->getLows();
+            auto closes = data->getCloses();
+            auto volumes = data->getVolumes();
+            const std::string& symbol = data->getSymbol();
+
+            size_t& row = *next;
+            for (; row < range.end && writer.size() < STREAM_CHUNK_BYTES; ++row) {
+                writer.beginObject(7)
+                    .key("symbol").value(symbol)
+                    .key("date").value(data->getDate(row))
+                    .key("open").value(opens[row])
+                    .key("high").value(highs[row])
+                    .key("low").value(lows[row])
+                    .key("close").value(closes[row])
+                    .key("volume").value(volumes[row])
+                    .endObject();
+            }
+            return row == range.end;
+        };
+
+        if (encoding == Encoding::Json) {
+            auto writer = std::make_shared<JsonWriter>(STREAM_CHUNK_BYTES + 256);
+            streamChunks(res, Metrics::Route::GetStock, contentType(encoding), [writer, writeRows, range, next](std::string_view& chunk) {
+                writer->clear();
+                if (*next == range.begin) writer->beginArray();
+                bool finished = writeRows(*writer);
+                if (finished) writer->endArray();
+                chunk = writer->str();
+                return finished;
+            });
+        } else {
+            auto writer = std::make_shared<BinaryWriter>(binaryFormat(encoding), STREAM_CHUNK_BYTES + 256);
+            streamChunks(res, Metrics::Route::GetStock, contentType(encoding), [writer, writeRows, range, next](std::string_view& chunk) {
+                writer->clear();
+                if (*next == range.begin) writer->beginArray(range.end - range.begin);
+                bool finished = writeRows(*writer);
+                chunk = writer->str();
+                return finished;
+            });
+        }
+    }
+
+    // Rows as one column frame: timestamps, then open, high, low, close, volume
+    void streamColumns(httplib::Response& res, std::shared_ptr<const PriceSeries> data, RowRange range,
+                       Encoding encoding) {
+        constexpr size_t VALUE_COLUMNS = 5;
+        auto buffer = std::make_shared<std::pmr::string>();
+        buffer->reserve(STREAM_CHUNK_BYTES + 1024);
+        // Column being written (0 is the timestamps) and the next row in it
+        auto column = std::make_shared<size_t>(0);
+        auto row = std::make_shared<size_t>(range.begin);
+        uint8_t valueBytes = columnValueBytes(encoding);
+
+        streamChunks(res, Metrics::Route::GetStock, contentType(encoding),
+            [data, range, buffer, column, row, valueBytes](std::string_view& chunk) {
+                buffer->clear();
+                if (*column == 0 && *row == range.begin) {
+                    json metadata = {
+                        {"symbol", data->getSymbol()},
+                        {"first_row", range.begin},
+                        {"columns", {"open", "high", "low", "close", "volume"}}
+                    };
+                    ColumnFrame::appendHeader(*buffer, valueBytes, VALUE_COLUMNS, range.end - range.begin,
+                                              metadata.dump());
+                }
+                const double* values[VALUE_COLUMNS] = {
+                    data->getOpens().data(), data->getHighs().data(), data->getLows().data(),
+                    data->getCloses().data(), data->getVolumes().data()
+                };
+                while (*column <= VALUE_COLUMNS && buffer->size() < STREAM_CHUNK_BYTES) {
+                    size_t width = *column == 0 ? sizeof(int64_t) : valueBytes;
+                    size_t room = (STREAM_CHUNK_BYTES - buffer->size() + width - 1) / width;
+                    size_t count = std::min(range.end - *row, room);
+                    if (*column == 0) {
+                        ColumnFrame::appendTimestamps(*buffer, data->getTimestamps().data() + *row, count);
+                    } else {
+                        ColumnFrame::appendValues(*buffer, valueBytes, values[*column - 1] + *row, count);
+                    }
+                    *row += count;
+                    if (*row == range.end) {
+                        ++*column;
+                        *row = range.begin;
+                    }
+                }
+                chunk = *buffer;
+                return *column > VALUE_COLUMNS;
+            });
+    }
+
+    // Tag of a gzip or deflate body: the identity tag with the coding appended
+    // inside the quotes, so a cache never takes one coding's bytes for another's
+    std::string codedTag(const std::string& etag, ContentCoding coding) {
+        return etag.substr(0, etag.size() - 1) + '-' + Compression::name(coding) + '"';
+    }
+
+    // Inverse of codedTag: the identity tag a coded one was made from
+    std::string stripCoding(const std::string& tag) {
+        for (ContentCoding coding : {ContentCoding::Gzip, ContentCoding::Deflate}) {
+            std::string suffix = std::string("-") + Compression::name(coding) + '"';
+            if (tag.size() > suffix.size() && tag.compare(tag.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                return tag.substr(0, tag.size() - suffix.size()) + '"';
+            }
+        }
+        return tag;
+    }
+
+    // If-None-Match uses weak comparison: W/"x" matches "x", and * matches
+    // anything. Coding suffixes are ignored too, since every coding of a
+    // representation holds the same data.
+    bool etagMatches(const httplib::Request& req, const std::string& etag) {
+        if (!req.has_header("If-None-Match")) return false;
+        std::string header = req.get_header_value("If-None-Match");
+
+        size_t pos = 0;
+        while (pos < header.size()) {
+            size_t end = header.find(',', pos);
+            if (end == std::string::npos) end = header.size();
+            std::string candidate = header.substr(pos, end - pos);
+            size_t first = candidate.find_first_not_of(" \t");
+            size_t last = candidate.find_last_not_of(" \t");
+            if (first != std::string::npos) {
+                candidate = candidate.substr(first, last - first + 1);
+                if (candidate.compare(0, 2, "W/") == 0) candidate.erase(0, 2);
+                if (candidate == "*" || stripCoding(candidate) == etag) return true;
+            }
+            pos = end + 1;
+        }
+        return false;
+    }
+
+    // Sets the validator headers; returns true when the client's copy is current
+    bool notModified(const httplib::Request& req, httplib::Response& res, const std::string& etag) {
+        res.set_header("ETag", etag);
+        res.set_header("Cache-Control", "no-cache");
+        if (!etagMatches(req, etag)) return false;
+        res.status = 304;
+        return true;
+    }
+
+    json batchResultToJson(const BatchSymbolResult& result) {
+        json entry = {
+            {"symbol", result.symbol},
+            {"elapsed_ms", result.elapsedMs}
+        };
+        if (!result.error.empty()) {
+            entry["error"] = result.error;
+            return entry;
+        }
+
+        json results = json::array();
+        for (const auto& prediction : result.results) {
+            json item = {{"algorithm", prediction.algorithm}};
+            if (prediction.error.empty()) {
+                item["predictions"] = prediction.predictions;
+            } else {
+                item["error"] = prediction.error;
+            }
+            results.push_back(std::move(item));
+        }
+        entry["results"] = std::move(results);
+        return entry;
+    }
+
+    // One frame per (symbol, algorithm) in request order, then one with the timing.
+    // Failures are frames with no rows and an "error" in the metadata.
+    void appendBatchFrames(std::pmr::string& frames, const std::vector<BatchSymbolResult>& results,
+                           const std::vector<AlgorithmSpec>& specs, const json& timing, Encoding encoding,
+                           const StockPredictor& predictor) {
+        for (const auto& result : results) {
+            if (!result.error.empty()) {
+                appendMetadataFrame(frames, {{"symbol", result.symbol}, {"error", result.error},
+                                             {"elapsed_ms", result.elapsedMs}});
+                continue;
+            }
+            for (size_t i = 0; i < result.results.size(); ++i) {
+                const BatchPrediction& prediction = result.results[i];
+                json metadata = {{"symbol", result.symbol}, {"algorithm", prediction.algorithm},
+                                 {"elapsed_ms", result.elapsedMs}};
+                if (!prediction.error.empty()) {
+                    metadata["error"] = prediction.error;
+                    appendMetadataFrame(frames, metadata);
+                    continue;
+                }
+                // Same settings as the batch ran with; only the lookback is needed
+                size_t lookback = predictor.getAlgorithm(specs[i].name, specs[i].parameters)->getLookback();
+                appendPredictionFrame(frames, encoding, std::move(metadata), *result.series, lookback,
+                                      prediction.predictions);
+            }
+        }
+        appendMetadataFrame(frames, {{"timing", timing}});
+    }
+
+    // "algorithms" entries are either names or {"name": ..., "parameters": {...}};
+    // when absent, every registered algorithm runs with its defaults
+    std::vector<AlgorithmSpec> parseAlgorithmSpecs(const json& body, const StockPredictor& predictor) {
+        std::vector<AlgorithmSpec> specs;
+        if (!body.contains("algorithms")) {
+            for (const auto& name : predictor.getAvailableAlgorithms()) {
+                specs.push_back({name, json()});
+            }
+            return specs;
+        }
+        if (!body["algorithms"].is_array()) {
+            throw std::runtime_error("'algorithms' must be an array");
+        }
+        for (const auto& algo : body["algorithms"]) {
+            if (algo.is_string()) {
+                specs.push_back({algo.get<std::string>(), json()});
+            } else if (algo.is_object() && algo.contains("name")) {
+                specs.push_back({algo["name"].get<std::string>(), algo.value("parameters", json())});
+            } else {
+                throw std::runtime_error("Each algorithm must be a name or an object with a 'name' field");
+            }
+        }
+        return specs;
+    }
+
+    // Backtest "algorithms" entries may add a "grid" of candidate values per
+    // parameter, e.g. {"name": "SMA", "grid": {"window_size": [5, 10, 20]}};
+    // every combination becomes its own spec, on top of any fixed "parameters"
+    std::vector<AlgorithmSpec> expandGrids(const json& body, const StockPredictor& predictor) {
+        std::vector<AlgorithmSpec> specs;
+        if (!body.contains("algorithms")) return parseAlgorithmSpecs(body, predictor);
+        if (!body["algorithms"].is_array()) {
+            throw std::runtime_error("'algorithms' must be an array");
+        }
+        for (const auto& algo : body["algorithms"]) {
+            json single = {{"algorithms", json::array({algo})}};
+            AlgorithmSpec base = parseAlgorithmSpecs(single, predictor).front();
+            if (!algo.is_object() || !algo.contains("grid")) {
+                specs.push_back(std::move(base));
+                continue;
+            }
+
+            const json& grid = algo["grid"];
+            if (!grid.is_object() || grid.empty()) {
+                throw std::runtime_error("'grid' must be an object of parameter value arrays");
+            }
+            std::vector<json> combinations = {base.parameters.is_object() ? base.parameters : json::object()};
+            for (const auto& axis : grid.items()) {
+                if (!axis.value().is_array() || axis.value().empty()) {
+                    throw std::runtime_error("Grid values for '" + axis.key() + "' must be a non-empty array");
+                }
+                std::vector<json> expanded;
+                for (const auto& partial : combinations) {
+                    for (const auto& value : axis.value()) {
+                        json combination = partial;
+                        combination[axis.key()] = value;
+                        expanded.push_back(std::move(combination));
+                    }
+                }
+                if (expanded.size() > MAX_BACKTEST_RUNS) {
+                    throw std::runtime_error("Parameter grid has more than " + std::to_string(MAX_BACKTEST_RUNS) +
+                                             " combinations");
+                }
+                combinations = std::move(expanded);
+            }
+            for (auto& parameters : combinations) {
+                specs.push_back({base.name, std::move(parameters)});
+            }
+        }
+        return specs;
+    }
+
+    json metricsToJson(const BacktestMetrics& metrics) {
+        return {
+            {"steps", metrics.steps},
+            {"mae", metrics.mae},
+            {"rmse", metrics.rmse},
+            {"mape", metrics.mape},
+            {"hit_rate", metrics.hitRate},
+            {"directional_steps", metrics.directionalSteps}
+        };
+    }
+
+    // A sweep axis is an array of values or a {"min", "max", "step"} range;
+    // min and max default to the algorithm's own limits
+    std::vector<double> parseSweepAxis(const json& body, const char* field, const json& limits,
+                                       const char* minKey, const char* maxKey, bool stepRequired) {
+        const json& axis = body[field];
+        std::vector<double> values;
+        if (axis.is_array()) {
+            if (axis.size() > ParameterSweep::MAX_SETTINGS) {
+                throw std::runtime_error(std::string("'") + field + "' has more than " +
+                                         std::to_string(ParameterSweep::MAX_SETTINGS) + " values");
+            }
+            for (const auto& value : axis) {
+                if (!value.is_number()) {
+                    throw std::runtime_error(std::string("'") + field + "' values must be numbers");
+                }
+                values.push_back(value.get<double>());
+            }
+        } else if (axis.is_object()) {
+            if (stepRequired && !axis.contains("step")) {
+                throw std::runtime_error(std::string("'") + field + "' range needs a 'step'");
+            }
+            double min = axis.value("min", limits[minKey].get<double>());
+            double max = axis.value("max", limits[maxKey].get<double>());
+            double step = axis.value("step", 1.0);
+            if (!(step > 0.0) || !(min <= max)) {
+                throw std::runtime_error(std::string("'") + field + "' range needs min <= max and a positive step");
+            }
+            // The epsilon keeps max itself when rounding leaves (max - min) / step just short
+            double span = std::floor((max - min) / step + 1e-9);
+            if (span >= static_cast<double>(ParameterSweep::MAX_SETTINGS)) {
+                throw std::runtime_error(std::string("'") + field + "' range has more than " +
+                                         std::to_string(ParameterSweep::MAX_SETTINGS) + " values");
+            }
+            for (size_t i = 0; i <= static_cast<size_t>(span); ++i) {
+                values.push_back(std::min(max, min + static_cast<double>(i) * step));
+            }
+        } else {
+            throw std::runtime_error(std::string("'") + field + "' must be an array or a {min, max, step} object");
+        }
+        if (values.empty()) {
+            throw std::runtime_error(std::string("'") + field + "' must not be empty");
+        }
+        return values;
+    }
+
+    // One array per row of a row-major sweep matrix
+    void writeSweepRows(JsonWriter& writer, const std::vector<double>& matrix, size_t rows, size_t columns) {
+        writer.key("predictions").beginArray();
+        for (size_t k = 0; k < rows; ++k) {
+            writer.beginArray();
+            for (size_t i = 0; i < columns; ++i) {
+                writer.value(matrix[k * columns + i]);
+            }
+            writer.endArray();
+        }
+        writer.endArray();
+    }
+
+    // Accepts {"bars": [bar, ...]} or a single bar object
+    PriceSeries parseBars(const std::string& symbol, const json& body) {
+        json bars = body.contains("bars") ? body["bars"] : json::array({body});
+        if (!bars.is_array() || bars.empty()) {
+            throw std::runtime_error("'bars' must be a non-empty array");
+        }
+
+        PriceSeries series(symbol);
+        series.reserve(bars.size());
+        for (const auto& bar : bars) {
+            if (!bar.is_object() || !bar.contains("date") || !bar["date"].is_string()) {
+                throw std::runtime_error("Each bar needs a 'date' string");
+            }
+            auto date = bar["date"].get<std::string>();
+            int64_t timestamp;
+            if (!DateTime::parse(date, timestamp)) {
+                throw std::runtime_error("Invalid bar date: " + date);
+            }
+            double values[5];
+            const char* fields[] = {"open", "high", "low", "close", "volume"};
+            for (int i = 0; i < 5; ++i) {
+                if (!bar.contains(fields[i]) || !bar[fields[i]].is_number()) {
+                    throw std::runtime_error(std::string("Each bar needs a numeric '") + fields[i] + "'");
+                }
+                values[i] = bar[fields[i]].get<double>();
+            }
+            series.append(date, timestamp, values[0], values[1], values[2], values[3], values[4]);
+        }
+        return series;
+    }
+
+    json batchTiming(double wallMs, double busyMs, size_t workers) {
+        return {
+            {"wall_ms", wallMs},
+            {"busy_ms", busyMs},
+            {"workers", workers},
+            {"speedup", wallMs > 0.0 ? busyMs / wallMs : 0.0}
+        };
+    }
+
+    // Hands NDJSON lines from batch worker threads to the thread writing the response
+    struct BatchChannel {
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<std::string> lines;
+        bool finished = false;
+        bool closed = false;
+
+        bool push(std::string line) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (closed) return false;
+                lines.push_back(std::move(line));
+            }
+            ready.notify_one();
+            return true;
+        }
+
+        void finish() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished = true;
+            }
+            ready.notify_one();
+        }
+    };
+}
+
+StockServer::StockServer(const std::string& dataDir, size_t cacheBudgetBytes, size_t workerThreads, size_t batchThreads,
+                         size_t predictionCachePercent)
+    : predictor(std::make_unique<StockPredictor>(dataDir, cacheBudgetBytes, batchThreads, predictionCachePercent)),
+      compressedCache(COMPRESSED_CACHE_BUDGET) {
+    if (workerThreads > 0) {
+        server.new_task_queue = [workerThreads] { return new httplib::ThreadPool(workerThreads); };
+    }
+    setupRoutes();
+}
+
+void StockServer::start(const std::string& host, int port) {
+    std::cout << "Server listening on http://" << host << ":" << port << std::endl;
+    std::cout << "Available endpoints:" << std::endl;
+    std::cout << "  GET  /" << std::endl;
+    std::cout << "  GET  /api/stocks/{symbol}" << std::endl;
+    std::cout << "  POST /api/stocks/{symbol}/bars" << std::endl;
+    std::cout << "  POST /api/predict" << std::endl;
+    std::cout << "  POST /api/predict/batch" << std::endl;
+    std::cout << "  POST /api/backtest" << std::endl;
+    std::cout << "  POST /api/sweep" << std::endl;
+    std::cout << "  POST /api/analyze" << std::endl;
+    std::cout << "  GET  /api/algorithms" << std::endl;
+    std::cout << "  GET  /api/cache/stats" << std::endl;
+    std::cout << "  GET  /metrics" << std::endl;
+    std::cout << "  GET  /ready" << std::endl;
+    std::cout << "  GET  /api/symbols" << std::endl;
+    
+    if (!server.listen(host.c_str(), port)) {
+        throw std::runtime_error("Failed to start server on port " + std::to_string(port));
+    }
+}
+
+void StockServer::setupRoutes() {
+    server.Get("/", instrument(Metrics::Route::Root, &StockServer::handleRoot));
+    server.Get(R"(/api/stocks/([^/]+))", instrument(Metrics::Route::GetStock, &StockServer::handleGetStock));
+    server.Post(R"(/api/stocks/([^/]+)/bars)", instrument(Metrics::Route::AppendBars, &StockServer::handleAppendBars));
+    server.Post("/api/predict", instrument(Metrics::Route::Predict, &StockServer::handlePredict));
+    server.Post("/api/predict/batch", instrument(Metrics::Route::PredictBatch, &StockServer::handlePredictBatch));
+    server.Post("/api/backtest", instrument(Metrics::Route::Backtest, &StockServer::handleBacktest));
+    server.Post("/api/sweep", instrument(Metrics::Route::Sweep, &StockServer::handleSweep));
+    server.Post("/api/analyze", instrument(Metrics::Route::Analyze, &StockServer::handleAnalyze));
+    server.Get("/api/algorithms", instrument(Metrics::Route::Algorithms, &StockServer::handleListAlgorithms));
+    server.Get("/api/cache/stats", instrument(Metrics::Route::CacheStats, &StockServer::handleCacheStats));
+    server.Get("/metrics", instrument(Metrics::Route::Metrics, &StockServer::handleMetrics));
+    server.Get("/ready", instrument(Metrics::Route::Ready, &StockServer::handleReady));
+    server.Get("/api/symbols", instrument(Metrics::Route::Symbols, &StockServer::handleListSymbols));
+    server.Post("/api/test", instrument(Metrics::Route::Test, &StockServer::handleTest));
+    server.Options(".*", instrument(Metrics::Route::Options, &StockServer::handleOptions));
+}
+
+httplib::Server::Handler StockServer::instrument(Metrics::Route route, Handler handler) {
+    return [this, route, handler](const httplib::Request& req, httplib::Response& res) {
+        auto start = std::chrono::steady_clock::now();
+        (this->*handler)(req, res);
+        // Streamed bodies are counted as their chunks are written
+        size_t bodyBytes = res.body.size();
+        encodeResponse(req, res, route);
+        Metrics::recordRequest(route, Metrics::elapsedSince(start), req.body.size(), bodyBytes, res.status >= 400);
+    };
+}
+
+void StockServer::encodeResponse(const httplib::Request& req, httplib::Response& res, Metrics::Route route) {
+    if (res.has_header("Content-Encoding")) return;
+    ContentCoding coding = Compression::negotiate(req.get_header_value("Accept-Encoding"));
+
+    if (res.status == 304) {
+        // Stands in for a response that may have been compressed: same Vary,
+        // and the coded tag when that is the copy the client holds
+        res.set_header("Vary", "Accept-Encoding");
+        if (coding != ContentCoding::Identity && res.has_header("ETag")) {
+            std::string coded = codedTag(res.get_header_value("ETag"), coding);
+            if (req.get_header_value("If-None-Match").find(coded) != std::string::npos) {
+                res.headers.erase("ETag");
+                res.set_header("ETag", coded);
+            }
+        }
+        return;
+    }
+
+    bool streamed = static_cast<bool>(res.content_provider_);
+    if (!streamed && res.body.size() < compressMinBytes) return;
+    res.set_header("Vary", "Accept-Encoding");
+    if (coding == ContentCoding::Identity) return;
+    res.set_header("Content-Encoding", Compression::name(coding));
+
+    // The coded ETag names the representation; the target tells apart
+    // ranges and pages of the same data. Errors are never cached.
+    std::string key;
+    if (res.has_header("ETag")) {
+        std::string coded = codedTag(res.get_header_value("ETag"), coding);
+        res.headers.erase("ETag");
+        res.set_header("ETag", coded);
+        if (res.status < 300) {
+            key = coded + ' ' + req.path;
+            for (const auto& param : req.params) {
+                key += (&param == &*req.params.begin() ? '?' : '&') + param.first + '=' + param.second;
+            }
+        }
+    }
+
+    if (!key.empty()) {
+        if (auto cached = compressedCache.get(key)) {
+            const CompressedBody& body = **cached;
+            if (streamed) {
+                // Served whole instead of running the chunked provider
+                res.content_provider_ = nullptr;
+                res.content_provider_resource_releaser_ = nullptr;
+                res.is_chunked_content_provider_ = false;
+                Metrics::addBytesOut(route, body.identityBytes);
+            }
+            res.body = body.bytes;
+            return;
+        }
+    }
+
+    if (!streamed) {
+        auto start = std::chrono::steady_clock::now();
+        auto body = std::make_shared<CompressedBody>();
+        body->bytes = Compression::compress(res.body, coding);
+        body->identityBytes = res.body.size();
+        Metrics::recordStage(Metrics::Stage::Compress, Metrics::elapsedSince(start));
+        Metrics::add(Metrics::Counter::CompressInputBytes, body->identityBytes);
+        Metrics::add(Metrics::Counter::CompressOutputBytes, body->bytes.size());
+        res.body = body->bytes;
+        if (!key.empty()) compressedCache.put(key, std::move(body), key.size() + res.body.size());
+        return;
+    }
+
+    // Chunked: compress each chunk as the handler's provider writes it, and
+    // keep the compressed stream for the cache unless it outgrows an entry
+    struct StreamState {
+        StreamCompressor compressor;
+        CompressedBody collected;
+        bool cacheable;
+        uint64_t compressNs = 0;
+
+        StreamState(ContentCoding coding, bool cache) : compressor(coding), cacheable(cache) {}
+    };
+    auto state = std::make_shared<StreamState>(coding, !key.empty());
+    size_t maxCachedBytes = COMPRESSED_CACHE_BUDGET / 16;
+    httplib::ContentProvider inner = std::move(res.content_provider_);
+    res.content_provider_ = [this, inner, state, key, maxCachedBytes](size_t offset, size_t length,
+                                                                     httplib::DataSink& sink) {
+        std::string out;
+        auto emit = [&](const char* data, size_t size, bool finish) {
+            auto start = std::chrono::steady_clock::now();
+            out.clear();
+            state->compressor.write(std::string_view(data, size), out);
+            if (finish) state->compressor.finish(out);
+            state->compressNs += Metrics::elapsedSince(start);
+            Metrics::add(Metrics::Counter::CompressInputBytes, size);
+            Metrics::add(Metrics::Counter::CompressOutputBytes, out.size());
+
+            if (state->cacheable) {
+                state->collected.bytes += out;
+                state->collected.identityBytes += size;
+                if (state->collected.bytes.size() > maxCachedBytes) {
+                    state->cacheable = false;
+                    std::string().swap(state->collected.bytes);
+                }
+            }
+            return out.empty() || sink.write(out.data(), out.size());
+        };
+
+        httplib::DataSink proxy;
+        proxy.is_writable = sink.is_writable;
+        proxy.write = [&](const char* data, size_t size) { return size == 0 || emit(data, size, false); };
+        proxy.done = [&] {
+            if (!emit(nullptr, 0, true)) return;
+            Metrics::recordStage(Metrics::Stage::Compress, state->compressNs);
+            if (state->cacheable) {
+                size_t cost = key.size() + state->collected.bytes.size();
+                compressedCache.put(key, std::make_shared<const CompressedBody>(std::move(state->collected)), cost);
+            }
+            sink.done();
+        };
+        return inner(offset, length, proxy);
+    };
+}
+
+// Root endpoint - health check
+void StockServer::handleRoot(const httplib::Request&, httplib::Response& res) {
+    json response = {
+        {"status", "running"},
+        {"message", "Stock Prediction API"},
+        {"version", "1.0.0"},
+        {"endpoints", {
+            {{"method", "GET"}, {"path", "/"}, {"description", "Health check"}},
+            {{"method", "GET"}, {"path", "/api/stocks/{symbol}"}, {"description", "Get historical stock data"}},
+            {{"method", "POST"}, {"path", "/api/stocks/{symbol}/bars"}, {"description", "Append new bars to a symbol"}},
+            {{"method", "POST"}, {"path", "/api/predict"}, {"description", "Get stock predictions"}},
+            {{"method", "POST"}, {"path", "/api/predict/batch"}, {"description", "Predict many symbols in parallel"}},
+            {{"method", "POST"}, {"path", "/api/backtest"}, {"description", "Score algorithms and parameter grids"}},
+            {{"method", "POST"}, {"path", "/api/sweep"}, {"description", "Every SMA window and EMA alpha in one pass"}},
+            {{"method", "POST"}, {"path", "/api/analyze"}, {"description", "Upload CSV file and get predictions"}},
+            {{"method", "GET"}, {"path", "/api/algorithms"}, {"description", "List available algorithms"}},
+            {{"method", "GET"}, {"path", "/api/cache/stats"}, {"description", "Historical data cache counters"}},
+            {{"method", "GET"}, {"path", "/metrics"}, {"description", "Prometheus metrics"}},
+            {{"method", "GET"}, {"path", "/ready"}, {"description", "Readiness and warm-up progress"}},
+            {{"method", "GET"}, {"path", "/api/symbols"}, {"description", "Symbol registry"}}
+        }}
+    };
+    res.set_header("Access-Control-Allow-Origin", "*");
+    res.set_content(response.dump(2), "application/json");
+}
+
+// GET /api/stocks/:symbol
+void StockServer::handleGetStock(const httplib::Request& req, httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    res.set_header("Access-Control-Expose-Headers", "ETag, X-Next-Cursor");
+    res.set_header("Vary", "Accept");
+    auto symbol = req.matches[1].str();
+    try {
+        Encoding encoding = negotiateEncoding(req);
+        if (notModified(req, res, representationTag(predictor->getDataTag(symbol), encoding))) return;
+
+        auto data = predictor->getHistoricalData(symbol);
+        RowRange range = selectRows(req, *data);
+        if (range.truncated) {
+            res.set_header("X-Next-Cursor", std::to_string(range.end));
+        }
+        if (isColumns(encoding)) {
+            streamColumns(res, std::move(data), range, encoding);
+        } else {
+            streamRows(res, std::move(data), range, encoding);
+        }
+    } catch (const std::invalid_argument& e) {
+        res.status = 400;
+        json error = {{"error", e.what()}};
+        res.set_content(error.dump(), "application/json");
+    } catch (const std::exception& e) {
+        res.status = 404;
+        json error = {{"error", e.what()}};
+        res.set_content(error.dump(), "application/json");
+    }
+}
+
+// POST /api/stocks/:symbol/bars - append bars; live predictions advance in O(1) per bar
+void StockServer::handleAppendBars(const httplib::Request& req, httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    auto symbol = req.matches[1].str();
+    try {
+        auto bars = parseBars(symbol, json::parse(req.body));
+        size_t updated = predictor->appendBars(symbol, bars);
+        json response = {
+            {"symbol", symbol},
+            {"appended", bars.size()},
+            {"live_series_updated", updated}
+        };
+        res.set_content(response.dump(), "application/json");
+    } catch (const std::exception& e) {
+        res.status = 400;
+        json error = {{"error", e.what()}};
+        res.set_content(error.dump(), "application/json");
+    }
+}
+
+// POST /api/predict
+void StockServer::handlePredict(const httplib::Request& req, httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    res.set_header("Access-Control-Expose-Headers", "ETag");
+    res.set_header("Vary", "Accept");
+    RequestArena arena;
+    try {
+        Encoding encoding = negotiateEncoding(req);
+        json body = json::parse(req.body);
+        auto symbol = body["symbol"].get<std::string>();
+        auto algorithm = body["algorithm"].get<std::string>();
+        json parameters = body.contains("parameters") ? body["parameters"] : json();
+        bool persist = body.value("persist", true);
+
+        // A date range computes only that window (plus warm-up bars)
+        // and is never persisted
+        bool ranged = body.contains("from") || body.contains("to");
+        std::string from = body.value("from", "");
+        std::string to = body.value("to", "");
+        std::string variant = ranged ? from + ".." + to : "";
+
+        if (notModified(req, res, representationTag(predictor->getPredictionTag(symbol, algorithm, parameters, variant),
+                                                    encoding))) {
+            return;
+        }
+
+        PredictionWindow window;
+        if (ranged) {
+            window = predictor->predictRange(
+                symbol, algorithm, parameters,
+                from.empty() ? std::numeric_limits<int64_t>::min() : periodBound(from, false),
+                to.empty() ? std::numeric_limits<int64_t>::max() : periodBound(to, true));
+        } else {
+            window = predictor->predict(symbol, algorithm, parameters, persist);
+        }
+
+        Metrics::ScopedTimer timer(Metrics::Stage::JsonSerialize);
+        size_t count = window.predictions.size();
+        if (isColumns(encoding)) {
+            std::pmr::string frame(arena.resource());
+            frame.reserve(count * (8 + columnValueBytes(encoding)) + 256);
+            appendPredictionFrame(frame, encoding, {{"symbol", symbol}, {"algorithm", algorithm}}, *window.series,
+                                  window.firstBar, window.predictions);
+            res.set_content(frame.data(), frame.size(), contentType(encoding).c_str());
+            return;
+        }
+        if (encoding != Encoding::Json) {
+            BinaryWriter writer(binaryFormat(encoding), count * 20 + symbol.size() + algorithm.size() + 64,
+                                arena.resource());
+            writePrediction(writer, symbol, algorithm, window);
+            res.set_content(writer.str().data(), writer.size(), contentType(encoding).c_str());
+            return;
+        }
+        JsonWriter writer(count * 40 + symbol.size() + algorithm.size() + 64, arena.resource());
+        writePrediction(writer, symbol, algorithm, window);
+        res.set_content(writer.str().data(), writer.size(), "application/json");
+    } catch (const std::exception& e) {
+        res.status = 400;
+        json error = {{"error", e.what()}};
+        res.set_content(error.dump(), "application/json");
+    }
+}
+
+// POST /api/predict/batch - many symbols in one request, fanned out across all cores
+void StockServer::handlePredictBatch(const httplib::Request& req, httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    res.set_header("Vary", "Accept");
+    RequestArena arena;
+    try {
+        json body = json::parse(req.body);
+        if (!body.contains("symbols") || !body["symbols"].is_array()) {
+            throw std::runtime_error("params must include 'symbols' array");
+        }
+        auto symbols = body["symbols"].get<std::vector<std::string>>();
+        auto specs = parseAlgorithmSpecs(body, *predictor);
+        for (const auto& spec : specs) {
+            predictor->getAlgorithm(spec.name, spec.parameters);
+        }
+
+        bool persist = body.value("persist", true);
+        bool stream = body.value("stream", false) ||
+                      req.get_header_value("Accept") == "application/x-ndjson";
+        Encoding encoding = negotiateEncoding(req);
+
+        if (!stream) {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<BatchSymbolResult> results(symbols.size());
+            predictor->predictBatch(symbols, specs, [&results](BatchSymbolResult&& result) {
+                // Each index is written by exactly one task
+                results[result.index] = std::move(result);
+                return true;
+            }, persist);
+            double wallMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+
+            Metrics::ScopedTimer timer(Metrics::Stage::JsonSerialize);
+            double busyMs = 0.0;
+            for (const auto& result : results) {
+                busyMs += result.elapsedMs;
+            }
+            json timing = batchTiming(wallMs, busyMs, predictor->getBatchThreadCount());
+            if (isColumns(encoding)) {
+                std::pmr::string frames(arena.resource());
+                appendBatchFrames(frames, results, specs, timing, encoding, *predictor);
+                res.set_content(frames.data(), frames.size(), contentType(encoding).c_str());
+                return;
+            }
+
+            json response = {{"results", json::array()}};
+            for (const auto& result : results) {
+                response["results"].push_back(batchResultToJson(result));
+            }
+            response["timing"] = std::move(timing);
+            if (encoding == Encoding::Json) {
+                res.set_content(response.dump(), "application/json");
+                return;
+            }
+            std::vector<std::uint8_t> bytes = encoding == Encoding::Cbor ? json::to_cbor(response)
+                                                                         : json::to_msgpack(response);
+            res.set_content(reinterpret_cast<const char*>(bytes.data()), bytes.size(), contentType(encoding).c_str());
+            return;
+        }
+
+        // NDJSON: one line per symbol as soon as it finishes, then a timing line
+        res.set_chunked_content_provider("application/x-ndjson",
+            [this, symbols, specs, persist](size_t, httplib::DataSink& sink) {
+                BatchChannel channel;
+                double busyMs = 0.0;
+                auto start = std::chrono::steady_clock::now();
+
+                std::thread runner([&] {
+                    try {
+                        predictor->predictBatch(symbols, specs, [&](BatchSymbolResult&& result) {
+                            double elapsed = result.elapsedMs;
+                            if (!channel.push(batchResultToJson(result).dump() + "\n")) return false;
+                            std::lock_guard<std::mutex> lock(channel.mutex);
+                            busyMs += elapsed;
+                            return true;
+                        }, persist);
+                    } catch (const std::exception& e) {
+                        channel.push(json({{"error", e.what()}}).dump() + "\n");
+                    }
+                    channel.finish();
+                });
+
+                // Only this thread touches the sink
+                std::unique_lock<std::mutex> lock(channel.mutex);
+                while (true) {
+                    channel.ready.wait(lock, [&channel] { return channel.finished || !channel.lines.empty(); });
+                    if (channel.lines.empty()) break;
+
+                    std::string line = std::move(channel.lines.front());
+                    channel.lines.pop_front();
+                    lock.unlock();
+                    bool written = sink.write(line.data(), line.size());
+                    if (written) Metrics::addBytesOut(Metrics::Route::PredictBatch, line.size());
+                    lock.lock();
+                    if (!written) {
+                        // Client went away: let queued symbols drain without running
+                        channel.closed = true;
+                        channel.lines.clear();
+                        channel.ready.wait(lock, [&channel] { return channel.finished; });
+                        break;
+                    }
+                }
+                bool clientGone = channel.closed;
+                lock.unlock();
+                runner.join();
+
+                if (clientGone) return false;
+                double wallMs = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+                std::string summary = json({{"timing", batchTiming(wallMs, busyMs, predictor->getBatchThreadCount())}}).dump() + "\n";
+                sink.write(summary.data(), summary.size());
+                Metrics::addBytesOut(Metrics::Route::PredictBatch, summary.size());
+                sink.done();
+                return true;
+            });
+    } catch (const std::exception& e) {
+        res.status = 400;
+        json error = {{"error", e.what()}};
+        res.set_content(error.dump(), "application/json");
+    }
+}
+
+// POST /api/backtest - walk-forward forecast accuracy over symbols x parameter grids
+void StockServer::handleBacktest(const httplib::Request& req, httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    try {
+        json body = json::parse(req.body);
+        std::vector<std::string> symbols;
+        if (body.contains("symbols")) {
+            if (!body["symbols"].is_array()) {
+                throw std::runtime_error("'symbols' must be an array");
+            }
+            symbols = body["symbols"].get<std::vector<std::string>>();
+        } else {
+            symbols = predictor->listSymbols();
+        }
+        auto specs = expandGrids(body, *predictor);
+        if (symbols.size() * specs.size() > MAX_BACKTEST_RUNS) {
+            throw std::runtime_error("Backtest would run " + std::to_string(symbols.size() * specs.size()) +
+                                     " evaluations; the limit is " + std::to_string(MAX_BACKTEST_RUNS));
+        }
+
+        BacktestWindow window;
+        if (body.contains("from")) window.from = periodBound(body["from"].get<std::string>(), false);
+        if (body.contains("to")) window.to = periodBound(body["to"].get<std::string>(), true);
+        if (body.contains("horizon")) {
+            const json& horizon = body["horizon"];
+            if (!horizon.is_number_integer() || horizon.get<int64_t>() < 1 ||
+                horizon.get<int64_t>() > static_cast<int64_t>(Backtester::MAX_HORIZON)) {
+                throw std::runtime_error("'horizon' must be an integer between 1 and " +
+                                         std::to_string(Backtester::MAX_HORIZON));
+            }
+            window.horizon = horizon.get<size_t>();
+        }
+        std::string rankBy = body.value("rank_by", "rmse");
+        Backtester::metric(BacktestMetrics{}, rankBy);  // rejects unknown names before any work
+        bool lowerIsBetter = Backtester::lowerIsBetter(rankBy);
+
+        auto start = std::chrono::steady_clock::now();
+        auto runs = predictor->backtest(symbols, specs, window);
+        double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        Metrics::ScopedTimer timer(Metrics::Stage::JsonSerialize);
+        json results = json::array();
+        json best = json::array();
+        double busyMs = 0.0;
+        for (size_t s = 0; s < symbols.size(); ++s) {
+            // Best-scoring parameters per algorithm for this symbol
+            std::map<std::string, size_t> bestByAlgorithm;
+            for (size_t k = 0; k < specs.size(); ++k) {
+                const BacktestRun& run = runs[s * specs.size() + k];
+                busyMs += run.elapsedMs;
+                json entry = {
+                    {"symbol", symbols[s]},
+                    {"algorithm", specs[k].name},
+                    {"parameters", specs[k].parameters.is_null() ? json::object() : specs[k].parameters}
+                };
+                if (!run.error.empty()) {
+                    entry["error"] = run.error;
+                } else {
+                    entry.update(metricsToJson(run.metrics));
+                    if (run.metrics.steps > 0) {
+                        auto it = bestByAlgorithm.find(specs[k].name);
+                        double value = Backtester::metric(run.metrics, rankBy);
+                        if (it == bestByAlgorithm.end()) {
+                            bestByAlgorithm[specs[k].name] = k;
+                        } else {
+                            double current = Backtester::metric(runs[s * specs.size() + it->second].metrics, rankBy);
+                            if (lowerIsBetter ? value < current : value > current) it->second = k;
+                        }
+                    }
+                }
+                results.push_back(std::move(entry));
+            }
+            for (const auto& winner : bestByAlgorithm) {
+                const BacktestRun& run = runs[s * specs.size() + winner.second];
+                best.push_back({
+                    {"symbol", symbols[s]},
+                    {"algorithm", winner.first},
+                    {"parameters", results[s * specs.size() + winner.second]["parameters"]},
+                    {rankBy, Backtester::metric(run.metrics, rankBy)}
+                });
+            }
+        }
+
+        json response = {
+            {"rank_by", rankBy},
+            {"horizon", window.horizon},
+            {"results", std::move(results)},
+            {"best", std::move(best)},
+            {"timing", batchTiming(wallMs, busyMs, predictor->getBatchThreadCount())}
+        };
+        res.set_content(response.dump(), "application/json");
+    } catch (const std::exception& e) {
+        res.status = 400;
+        json error = {{"error", e.what()}};
+        res.set_content(error.dump(), "application/json");
+    }
+}
+
+// POST /api/sweep - every SMA window and EMA alpha of a range in one pass
+void StockServer::handleSweep(const httplib::Request& req, httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    RequestArena arena;
+    try {
+        json body = json::parse(req.body);
+        if (!body.contains("symbol") || !body["symbol"].is_string()) {
+            throw std::runtime_error("params must include 'symbol'");
+        }
+        auto symbol = body["symbol"].get<std::string>();
+        if (!body.contains("sma") && !body.contains("ema")) {
+            throw std::runtime_error("params must include 'sma' windows, 'ema' alphas or both");
+        }
+
+        std::vector<int> windows;
+        if (body.contains("sma")) {
+            auto limits = predictor->getAlgorithm("SMA")->getParameters();
+            for (double window : parseSweepAxis(body, "sma", limits, "min_window", "max_window", false)) {
+                if (window != std::floor(window)) {
+                    throw std::runtime_error("'sma' windows must be integers");
+                }
+                // Clamped only so the cast is defined; the algorithm rejects it
+                windows.push_back(static_cast<int>(std::max(std::min(window, 1e9), -1e9)));
+            }
+        }
+        std::vector<double> alphas;
+        if (body.contains("ema")) {
+            auto limits = predictor->getAlgorithm("EMA")->getParameters();
+            alphas = parseSweepAxis(body, "ema", limits, "min_alpha", "max_alpha", true);
+        }
+        int64_t from = body.contains("from") ? periodBound(body["from"].get<std::string>(), false)
+                                             : std::numeric_limits<int64_t>::min();
+        int64_t to = body.contains("to") ? periodBound(body["to"].get<std::string>(), true)
+                                         : std::numeric_limits<int64_t>::max();
+
+        SweepResult sweep = predictor->sweep(symbol, std::move(windows), std::move(alphas), from, to);
+
+        Metrics::ScopedTimer timer(Metrics::Stage::JsonSerialize);
+        size_t rows = sweep.windows.size() + sweep.alphas.size();
+        JsonWriter writer((rows + 1) * sweep.columns * 20 + 256, arena.resource());
+        writer.beginObject()
+            .key("symbol").value(symbol)
+            .key("first_bar").value(static_cast<uint64_t>(sweep.firstBar))
+            .key("columns").value(static_cast<uint64_t>(sweep.columns))
+            .key("dates").beginArray();
+        for (size_t i = 0; i < sweep.columns; ++i) {
+            writer.value(sweep.series->getDate(sweep.firstBar + i));
+        }
+        writer.endArray();
+        if (!sweep.windows.empty()) {
+            writer.key("sma").beginObject().key("window_size").beginArray();
+            for (int window : sweep.windows) writer.value(window);
+            writer.endArray();
+            writeSweepRows(writer, sweep.sma, sweep.windows.size(), sweep.columns);
+            writer.endObject();
+        }
+        if (!sweep.alphas.empty()) {
+            writer.key("ema").beginObject().key("alpha").beginArray();
+            for (double alpha : sweep.alphas) writer.value(alpha);
+            writer.endArray();
+            writeSweepRows(writer, sweep.ema, sweep.alphas.size(), sweep.columns);
+            writer.endObject();
+        }
+        writer.endObject();
+        res.set_content(writer.str().data(), writer.size(), "application/json");
+    } catch (const std::exception& e) {
+        res.status = 400;
+        json error = {{"error", e.what()}};
+        res.set_content(error.dump(), "application/json");
+    }
+}
+
+// POST /api/analyze - Upload CSV and get predictions
+void StockServer::handleAnalyze(const httplib::Request& req, httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    RequestArena arena;
+
+    LOG_DEBUG("POST /api/analyze: Content-Type " << req.get_header_value("Content-Type")
+              << ", body " << req.body.size() << " bytes, "
+              << req.files.size() << " files, " << req.params.size() << " params");
+    for (const auto& f : req.files) {
+        LOG_DEBUG("  file key: " << f.first << " (name: " << f.second.filename << ")");
+    }
+    
+    try {
+        // Check if file was uploaded
+        if (!req.has_file("csv_file")) {
+            LOG_DEBUG("POST /api/analyze: no csv_file in request");
+            throw std::runtime_error("No CSV file uploaded");
+        }
+
+        // Get the uploaded file
+        const auto& file = req.get_file_value("csv_file");
+        
+        // Parse optional algorithm and limit from form fields
+        // In multipart/form-data, regular fields might be in params or files
+        std::string algorithm = "";
+        if (req.has_param("algorithm")) {
+            algorithm = req.get_param_value("algorithm");
+        } else if (req.has_file("algorithm")) {
+            // Sometimes form fields come as files in multipart
+            algorithm = req.get_file_value("algorithm").content;
+        }
+        
+        int limit = 10;
+        std::string limitStr = "";
+        if (req.has_param("limit")) {
+            limitStr = req.get_param_value("limit");
+        } else if (req.has_file("limit")) {
+            // Sometimes form fields come as files in multipart
+            limitStr = req.get_file_value("limit").content;
+        }
+        
+        if (!limitStr.empty()) {
+            try {
+                limit = std::stoi(limitStr);
+                // Validate limit
+                if (limit < 1 || limit > 100) {
+                    limit = 10; // Reset to default if out of range
+                }
+            } catch (const std::exception&) {
+                limit = 10; // Use default if parsing fails
+            }
+        }
+
+        // Determine which algorithms to use
+        std::vector<AlgorithmSpec> specs;
+        if (!algorithm.empty()) {
+            specs.push_back({algorithm, nullptr});
+        } else {
+            // Use all available algorithms if none specified
+            for (const auto& algo : predictor->getAvailableAlgorithms()) {
+                specs.push_back({algo, nullptr});
+            }
+        }
+
+        // Parse the upload in memory once; nothing touches the data directory
+        std::vector<CsvParseError> parseErrors;
+        auto series = std::make_shared<const PriceSeries>(
+            StockCsvParser::parse(file.content, "upload", &parseErrors));
+
+        json response = {
+            {"predictions", json::object()},
+            {"validations", json::array()},
+            {"errors", json::array()},
+            {"metadata", {
+                {"limit", limit},
+                {"algorithms_requested", algorithm.empty() ? "all" : algorithm},
+                {"file_name", file.filename},
+                {"rows", series->size()},
+                {"skipped_rows", parseErrors.size()}
+            }}
+        };
+
+        // Report the first few rejected rows with their line numbers
+        json rowErrors = json::array();
+        for (size_t i = 0; i < parseErrors.size() && i < MAX_REPORTED_ROW_ERRORS; ++i) {
+            rowErrors.push_back({{"line", parseErrors[i].line}, {"error", parseErrors[i].message}});
+        }
+        response["metadata"]["row_errors"] = rowErrors;
+
+        // Every algorithm runs over the same parsed series, computing only
+        // the first `limit` predictions
+        auto results = predictor->analyze(series, specs, static_cast<size_t>(limit));
+        for (const auto& result : results) {
+            if (!result.error.empty()) {
+                response["errors"].push_back({
+                    {"algorithm", result.algorithm},
+                    {"error", result.error}
+                });
+                continue;
+            }
+            response["predictions"][result.algorithm] = result.predictions;
+            response["validations"].push_back({
+                {"algorithm", result.algorithm},
+                {"parameters", predictor->getAlgorithm(result.algorithm)->getParameters()},
+                {"prediction_count", result.predictions.size()}
+            });
+        }
+
+        std::string payload;
+        {
+            Metrics::ScopedTimer timer(Metrics::Stage::JsonSerialize);
+            payload = response.dump(2);
+        }
+        res.set_content(payload, "application/json");
+
+    } catch (const std::exception& e) {
+        res.status = 400;
+        json error = {{"error", e.what()}};
+        res.set_content(error.dump(), "application/json");
+    }
+}
+
+// GET /api/algorithms
+void StockServer::handleListAlgorithms(const httplib::Request&, httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    auto algorithms = predictor->getAvailableAlgorithms();
+    json response = algorithms;
+    res.set_content(response.dump(), "application/json");
+}
+
+// GET /api/cache/stats
+void StockServer::handleCacheStats(const httplib::Request&, httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    auto stats = predictor->getCacheStats();
+    auto results = predictor->getResultCacheStats();
+    auto live = predictor->getLiveSeriesStats();
+    auto persist = predictor->getPersistStats();
+    auto compressed = getCompressedCacheStats();
+    json response = {
+        {"hits", stats.hits},
+        {"misses", stats.misses},
+        {"evictions", stats.evictions},
+        {"entries", stats.entries},
+        {"used_bytes", stats.usedBytes},
+        {"capacity_bytes", stats.capacityBytes},
+        {"predictions", {
+            {"hits", results.hits},
+            {"misses", results.misses},
+            {"evictions", results.evictions},
+            {"entries", results.entries},
+            {"used_bytes", results.usedBytes},
+            {"capacity_bytes", results.capacityBytes}
+        }},
+        {"live", {
+            {"hits", live.hits},
+            {"misses", live.misses},
+            {"evictions", live.evictions},
+            {"entries", live.entries},
+            {"used_bytes", live.usedBytes},
+            {"capacity_bytes", live.capacityBytes}
+        }},
+        {"compressed", {
+            {"hits", compressed.hits},
+            {"misses", compressed.misses},
+            {"evictions", compressed.evictions},
+            {"entries", compressed.entries},
+            {"used_bytes", compressed.usedBytes},
+            {"capacity_bytes", compressed.capacityBytes}
+        }},
+        {"persistence", {
+            {"queued", persist.queued},
+            {"coalesced", persist.coalesced},
+            {"dropped", persist.dropped},
+            {"written", persist.written},
+            {"failed", persist.failed},
+            {"pending", persist.pending}
+        }}
+    };
+    res.set_content(response.dump(), "application/json");
+}
+
+// GET /metrics - Prometheus text exposition
+void StockServer::handleMetrics(const httplib::Request&, httplib::Response& res) {
+    std::string out;
+    out.reserve(64 * 1024);
+    Metrics::writePrometheus(out);
+
+    // Cache and persistence counters are kept by their owners; export them as-is
+    struct CacheMetrics {
+        const char* name;
+        CacheStats stats;
+    };
+    const CacheMetrics caches[] = {
+        {"series", predictor->getCacheStats()},
+        {"predictions", predictor->getResultCacheStats()},
+        {"live", predictor->getLiveSeriesStats()},
+        {"compressed", getCompressedCacheStats()}
+    };
+    struct CacheField {
+        const char* metric;
+        const char* type;
+        const char* help;
+        uint64_t CacheStats::*counter;
+        size_t CacheStats::*gauge;
+    };
+    const CacheField fields[] = {
+        {"stock_cache_hits_total", "counter", "Cache lookups that found a current entry.", &CacheStats::hits, nullptr},
+        {"stock_cache_misses_total", "counter", "Cache lookups that missed or found a stale entry.", &CacheStats::misses, nullptr},
+        {"stock_cache_evictions_total", "counter", "Entries evicted to stay within budget.", &CacheStats::evictions, nullptr},
+        {"stock_cache_entries", "gauge", "Entries currently cached.", nullptr, &CacheStats::entries},
+        {"stock_cache_used_bytes", "gauge", "Bytes currently charged to the cache.", nullptr, &CacheStats::usedBytes},
+        {"stock_cache_capacity_bytes", "gauge", "Cache budget in bytes.", nullptr, &CacheStats::capacityBytes}
+    };
+    for (const auto& field : fields) {
+        out += std::string("# HELP ") + field.metric + " " + field.help + "\n";
+        out += std::string("# TYPE ") + field.metric + " " + field.type + "\n";
+        for (const auto& cache : caches) {
+            uint64_t value = field.counter ? cache.stats.*field.counter : cache.stats.*field.gauge;
+            out += std::string(field.metric) + "{cache=\"" + cache.name + "\"} " + std::to_string(value) + "\n";
+        }
+    }
+
+    auto persist = predictor->getPersistStats();
+    const std::pair<const char*, uint64_t> persistCounters[] = {
+        {"queued", persist.queued},
+        {"coalesced", persist.coalesced},
+        {"dropped", persist.dropped},
+        {"written", persist.written},
+        {"failed", persist.failed}
+    };
+    out += "# HELP stock_persist_jobs_total Prediction file jobs by event.\n";
+    out += "# TYPE stock_persist_jobs_total counter\n";
+    for (const auto& counter : persistCounters) {
+        out += std::string("stock_persist_jobs_total{event=\"") + counter.first + "\"} " +
+               std::to_string(counter.second) + "\n";
+    }
+    out += "# HELP stock_persist_pending Prediction files waiting to be written.\n";
+    out += "# TYPE stock_persist_pending gauge\n";
+    out += "stock_persist_pending " + std::to_string(persist.pending) + "\n";
+
+    res.set_content(out, "text/plain; version=0.0.4; charset=utf-8");
+}
+
+// GET /ready - 503 while the startup warm-up runs, 200 once it is done (or disabled)
+void StockServer::handleReady(const httplib::Request&, httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    static const char* const states[] = {"disabled", "scanning", "loading", "ready"};
+    WarmupProgress progress = predictor->getWarmupProgress();
+    bool ready = predictor->isReady();
+    json response = {
+        {"status", ready ? "ready" : "warming"},
+        {"warmup", {
+            {"state", states[static_cast<int>(progress.state)]},
+            {"symbols_total", progress.symbolsTotal},
+            {"symbols_done", progress.symbolsDone},
+            {"symbols_cached", progress.symbolsResident},
+            {"symbols_failed", progress.symbolsFailed},
+            {"cached_bytes", progress.residentBytes},
+            {"memory_cap_bytes", progress.memoryCapBytes},
+            {"elapsed_ms", progress.elapsedMs}
+        }}
+    };
+    res.status = ready ? 200 : 503;
+    res.set_header("Cache-Control", "no-store");
+    res.set_content(response.dump(), "application/json");
+}
+
+// GET /api/symbols - the symbol registry built by the warm-up
+void StockServer::handleListSymbols(const httplib::Request&, httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    auto formatDate = [](int64_t timestamp) {
+        return DateTime::format(timestamp, timestamp % DateTime::SECONDS_PER_DAY != 0);
+    };
+    json symbols = json::array();
+    for (const auto& info : predictor->getSymbolInfo()) {
+        json entry = {{"symbol", info.symbol}};
+        if (!info.error.empty()) {
+            entry["error"] = info.error;
+        } else {
+            entry["rows"] = info.rows;
+            entry["first_date"] = info.rows > 0 ? json(formatDate(info.firstTimestamp)) : json(nullptr);
+            entry["last_date"] = info.rows > 0 ? json(formatDate(info.lastTimestamp)) : json(nullptr);
+            entry["modified_time"] = info.version.modifiedTime;
+            entry["file_bytes"] = info.version.size;
+            entry["memory_bytes"] = info.memoryBytes;
+        }
+        symbols.push_back(std::move(entry));
+    }
+    res.set_content(json({{"symbols", std::move(symbols)}}).dump(), "application/json");
+}
+
+// POST /api/test - Simple test endpoint for debugging
+void StockServer::handleTest(const httplib::Request& req, httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    LOG_DEBUG("POST /api/test: " << req.body);
+    
+    json response = {
+        {"status", "success"},
+        {"message", "POST request received successfully"},
+        {"body_length", req.body.size()},
+        {"has_files", req.files.size() > 0}
+    };
+    res.set_content(response.dump(2), "application/json");
+}
+
+// CORS support
+void StockServer::handleOptions(const httplib::Request&, httplib::Response& res) {
+    res.set_header("Access-Control-Allow-Origin", "*");
+    res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+    res.set_header("Access-Control-Allow-Headers", "Content-Type, If-None-Match");
+}
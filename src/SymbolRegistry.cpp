@@ -0,0 +1,93 @@
+#include "../include/SymbolRegistry.h"
+
+ResidentReservation::~ResidentReservation() {
+    registry.releaseResident(bytes);
+}
+
+void SymbolRegistry::update(SymbolInfo info) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string symbol = info.symbol;
+    symbols[symbol] = std::move(info);
+}
+
+std::optional<SymbolInfo> SymbolRegistry::find(const std::string& symbol) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = symbols.find(symbol);
+    if (it == symbols.end()) return std::nullopt;
+    return it->second;
+}
+
+std::vector<SymbolInfo> SymbolRegistry::list() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<SymbolInfo> entries;
+    entries.reserve(symbols.size());
+    for (const auto& entry : symbols) {
+        entries.push_back(entry.second);
+    }
+    return entries;
+}
+
+void SymbolRegistry::beginWarmup(size_t capBytes) {
+    startedAt = std::chrono::steady_clock::now();
+    memoryCapBytes.store(capBytes);
+    state.store(WarmupState::Scanning);
+}
+
+void SymbolRegistry::beginLoading(size_t total) {
+    symbolsTotal.store(total);
+    state.store(WarmupState::Loading);
+}
+
+std::shared_ptr<const ResidentReservation> SymbolRegistry::reserveResident(size_t bytes) {
+    size_t cap = memoryCapBytes.load(std::memory_order_relaxed);
+    // Reserve first so loads finishing together cannot overshoot the cap
+    if (residentBytes.fetch_add(bytes) + bytes > cap) {
+        residentBytes.fetch_sub(bytes);
+        return nullptr;
+    }
+    symbolsResident.fetch_add(1, std::memory_order_relaxed);
+    return std::make_shared<const ResidentReservation>(*this, bytes);
+}
+
+void SymbolRegistry::releaseResident(size_t bytes) {
+    symbolsResident.fetch_sub(1, std::memory_order_relaxed);
+    residentBytes.fetch_sub(bytes);
+}
+
+void SymbolRegistry::warmed(SymbolInfo info) {
+    if (!info.error.empty()) symbolsFailed.fetch_add(1, std::memory_order_relaxed);
+    update(std::move(info));
+    symbolsDone.fetch_add(1);
+}
+
+void SymbolRegistry::finishWarmup() {
+    elapsedNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - startedAt).count());
+    state.store(WarmupState::Ready);
+}
+
+WarmupProgress SymbolRegistry::getProgress() const {
+    WarmupProgress progress;
+    progress.state = state.load();
+    progress.symbolsTotal = symbolsTotal.load();
+    progress.symbolsDone = symbolsDone.load();
+    progress.symbolsResident = symbolsResident.load(std::memory_order_relaxed);
+    progress.symbolsFailed = symbolsFailed.load(std::memory_order_relaxed);
+    progress.residentBytes = residentBytes.load(std::memory_order_relaxed);
+    progress.memoryCapBytes = memoryCapBytes.load();
+    if (progress.state == WarmupState::Disabled) return progress;
+
+    int64_t finishedNs = elapsedNs.load();
+    if (finishedNs >= 0) {
+        progress.elapsedMs = static_cast<double>(finishedNs) / 1e6;
+    } else {
+        progress.elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - startedAt).count();
+    }
+    return progress;
+}
+
+bool SymbolRegistry::isReady() const {
+    WarmupState current = state.load();
+    return current == WarmupState::Disabled || current == WarmupState::Ready;
+}
@@ -0,0 +1,119 @@
+#include "../include/TaskScheduler.h"
+#include <algorithm>
+#include <exception>
+
+TaskScheduler::TaskScheduler(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    queues.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&TaskScheduler::workerLoop, this, i);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void TaskScheduler::push(std::function<void()> task) {
+    size_t index = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // Publish under wakeMutex so a worker about to sleep cannot miss it
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        queuedTasks.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_one();
+}
+
+bool TaskScheduler::runOne(size_t preferredQueue) {
+    std::function<void()> task;
+    const size_t queueCount = queues.size();
+
+    // Own queue first (newest task, still warm in cache), then steal the
+    // oldest task from the others
+    for (size_t attempt = 0; attempt < queueCount && !task; ++attempt) {
+        WorkerQueue& queue = *queues[(preferredQueue + attempt) % queueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        if (attempt == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+
+    if (!task) return false;
+    queuedTasks.fetch_sub(1, std::memory_order_acq_rel);
+    task();
+    return true;
+}
+
+void TaskScheduler::workerLoop(size_t index) {
+    while (true) {
+        if (runOne(index)) continue;
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wake.wait(lock, [this] {
+            return stopping || queuedTasks.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping && queuedTasks.load(std::memory_order_acquire) == 0) return;
+    }
+}
+
+void TaskScheduler::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) return;
+
+    struct Job {
+        std::atomic<size_t> remaining;
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+    auto job = std::make_shared<Job>();
+    job->remaining.store(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        push([job, &body, i] {
+            try {
+                body(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                if (!job->error) job->error = std::current_exception();
+            }
+            if (job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                job->finished.notify_all();
+            }
+        });
+    }
+
+    // Help out instead of blocking while work is still queued
+    size_t start = nextQueue.load(std::memory_order_relaxed);
+    while (job->remaining.load(std::memory_order_acquire) > 0 && runOne(start)) {
+    }
+
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->finished.wait(lock, [&job] { return job->remaining.load(std::memory_order_acquire) == 0; });
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
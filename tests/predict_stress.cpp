@@ -0,0 +1,361 @@
+// Drives StockServer::handlePredict from many threads at once and checks
+// every response against the one the same request got single-threaded.
+//
+// The cache budget is kept small so series and results are evicted and
+// reloaded while other threads read them. Alongside the predictions, one
+// thread registers new algorithms, one appends bars to a symbol that is
+// predicted live, and one reads the cache statistics. Build with
+// -DSTOCK_SANITIZER=thread to have the races reported.
+//
+// Before that, a bar is appended to a symbol stored only as a snapshot and
+// its predictions are checked to still cover the snapshot's history.
+
+#include "../include/DateTime.h"
+#include "../include/FileHandler.h"
+#include "../include/Snapshot.h"
+#include "../include/StockServer.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+    constexpr size_t SYMBOLS = 6;
+    constexpr size_t ROWS = 5000;
+    // Room for a few series at a time, so most requests evict something
+    constexpr size_t CACHE_BUDGET = 1024 * 1024;
+    constexpr size_t THREADS = 16;
+    constexpr size_t REQUESTS_PER_THREAD = 100;
+    const char* LIVE_SYMBOL = "LIVE";
+    const char* SNAPSHOT_SYMBOL = "SNAP";
+
+    std::mutex reportMutex;
+    std::atomic<size_t> failures{0};
+
+    void fail(const std::string& message) {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        if (failures.fetch_add(1) < 20) std::cerr << "FAIL " << message << "\n";
+    }
+
+    // httplib sends 200 when a handler leaves the status unset
+    int statusOf(const httplib::Response& res) {
+        return res.status == -1 ? 200 : res.status;
+    }
+
+    std::string excerpt(const std::string& body) {
+        return body.size() > 200 ? body.substr(0, 200) + "..." : body;
+    }
+
+    const int64_t START = DateTime::daysFromCivil(2000, 1, 3) * DateTime::SECONDS_PER_DAY;
+
+    void writeCsv(const fs::path& path, size_t rows, uint64_t seed) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not create file: " + path.string());
+        }
+        out << "Date,Open,High,Low,Close,Volume\n";
+
+        std::mt19937_64 random(seed);
+        std::normal_distribution<double> step(0.0, 0.8);
+        std::uniform_real_distribution<double> spread(0.0, 0.5);
+        double close = 100.0;
+        char line[128];
+        for (size_t i = 0; i < rows; ++i) {
+            double open = close;
+            close = std::max(1.0, open + step(random));
+            double high = std::max(open, close) + spread(random);
+            double low = std::max(0.5, std::min(open, close) - spread(random));
+            int length = std::snprintf(line, sizeof(line), "%s,%.2f,%.2f,%.2f,%.2f,%d\n",
+                                       DateTime::format(START + static_cast<int64_t>(i) * 60, true).c_str(),
+                                       open, high, low, close, 1000 + static_cast<int>(i % 5000));
+            out.write(line, length);
+        }
+        if (!out) throw std::runtime_error("Could not write file: " + path.string());
+    }
+
+    struct Case {
+        std::string symbol;
+        std::string algorithm;
+        json parameters;
+        std::string accept;  // empty for JSON
+        std::string body;    // the single-threaded response
+        std::string etag;
+    };
+
+    std::vector<Case> makeCases() {
+        const std::vector<std::pair<std::string, json>> algorithms = {
+            {"SMA", {{"window_size", 5}}},
+            {"SMA", {{"window_size", 50}}},
+            {"SMA", {{"window_size", 200}}},
+            {"EMA", {{"alpha", 0.2}}},
+            {"EMA", {{"alpha", 0.05}}},
+            {"WMA", {{"window_size", 10}}},
+            {"BOLLINGER", {{"window_size", 20}, {"num_std", 2.0}, {"band", "upper"}}},
+            {"RSI", {{"period", 14}}},
+            {"MACD", {{"fast_period", 12}, {"slow_period", 26}, {"signal_period", 9}, {"output", "signal"}}},
+            {"ATR", {{"period", 14}}}
+        };
+        std::vector<Case> cases;
+        for (size_t s = 0; s < SYMBOLS; ++s) {
+            for (const auto& algorithm : algorithms) {
+                for (const char* accept : {"", "application/cbor"}) {
+                    cases.push_back({"S" + std::to_string(s), algorithm.first, algorithm.second, accept, "", ""});
+                }
+            }
+        }
+        return cases;
+    }
+
+    // Sends one bar dated row minutes after START to handleAppendBars
+    httplib::Response appendBar(StockServer& server, const std::string& symbol, size_t row, double price) {
+        httplib::Request req;
+        req.method = "POST";
+        req.path = "/api/stocks/" + symbol + "/bars";
+        std::string path = req.path;
+        std::regex_match(path, req.matches, std::regex(R"(/api/stocks/([^/]+)/bars)"));
+        req.body = json{{"date", DateTime::format(START + static_cast<int64_t>(row) * 60, true)},
+                        {"open", price}, {"high", price + 1}, {"low", price - 1}, {"close", price},
+                        {"volume", 1000}}.dump();
+        httplib::Response res;
+        server.handleAppendBars(req, res);
+        return res;
+    }
+
+    httplib::Request predictRequest(const std::string& symbol, const std::string& algorithm, const json& parameters,
+                                    const std::string& accept, bool persist) {
+        httplib::Request req;
+        req.method = "POST";
+        req.path = "/api/predict";
+        req.body = json{{"symbol", symbol}, {"algorithm", algorithm}, {"parameters", parameters},
+                        {"persist", persist}}.dump();
+        if (!accept.empty()) req.headers.emplace("Accept", accept);
+        return req;
+    }
+
+    std::string describe(const Case& c) {
+        return c.symbol + " " + c.algorithm + " " + c.parameters.dump() + (c.accept.empty() ? "" : " " + c.accept);
+    }
+
+    void predictLoop(StockServer& server, const std::vector<Case>& cases, uint64_t seed) {
+        std::mt19937_64 random(seed);
+        std::uniform_int_distribution<size_t> pick(0, cases.size() - 1);
+        std::uniform_int_distribution<int> roll(0, 9);
+        for (size_t i = 0; i < REQUESTS_PER_THREAD; ++i) {
+            const Case& c = cases[pick(random)];
+            int dice = roll(random);
+            // Persisting queues a write; the response must not change
+            httplib::Request req = predictRequest(c.symbol, c.algorithm, c.parameters, c.accept, dice == 0);
+            bool conditional = dice == 1;
+            if (conditional) req.headers.emplace("If-None-Match", c.etag);
+
+            httplib::Response res;
+            server.handlePredict(req, res);
+            if (conditional) {
+                if (statusOf(res) != 304) {
+                    fail(describe(c) + ": expected 304, got " + std::to_string(statusOf(res)));
+                }
+            } else if (statusOf(res) != 200) {
+                fail(describe(c) + ": status " + std::to_string(statusOf(res)) + " " + excerpt(res.body));
+            } else if (res.body != c.body) {
+                fail(describe(c) + ": body differs from the single-threaded response");
+            } else if (res.get_header_value("ETag") != c.etag) {
+                fail(describe(c) + ": ETag " + res.get_header_value("ETag") + ", expected " + c.etag);
+            }
+        }
+    }
+
+    // Registers a new SMA variant now and then and predicts with each one
+    void registerLoop(StockServer& server, const std::atomic<bool>& stop) {
+        for (int k = 0; !stop.load(); ++k) {
+            std::string name = "STRESS_SMA_" + std::to_string(k);
+            int window = 2 + k % 40;
+            server.getPredictor().registerAlgorithm(name, std::make_unique<MovingAverageAlgorithm>(window));
+
+            httplib::Response res;
+            server.handlePredict(predictRequest("S" + std::to_string(k % SYMBOLS), name, json(), "", false), res);
+            if (statusOf(res) != 200) {
+                fail(name + ": status " + std::to_string(statusOf(res)) + " " + excerpt(res.body));
+                continue;
+            }
+            size_t count = json::parse(res.body)["predictions"].size();
+            if (count != ROWS - window + 1) {
+                fail(name + ": " + std::to_string(count) + " predictions, expected " +
+                     std::to_string(ROWS - window + 1));
+            }
+
+            httplib::Response list;
+            server.handleListAlgorithms(httplib::Request(), list);
+            if (list.body.find("\"" + name + "\"") == std::string::npos) {
+                fail(name + ": missing from /api/algorithms");
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    // Appends one bar at a time to LIVE_SYMBOL while its SMA is predicted
+    void appendLoop(StockServer& server, const std::atomic<bool>& stop) {
+        size_t rows = ROWS;
+        for (size_t k = 0; !stop.load(); ++k) {
+            double price = 100.0 + static_cast<double>(k % 17);
+            httplib::Response res = appendBar(server, LIVE_SYMBOL, rows, price);
+            if (statusOf(res) != 200) {
+                fail(std::string("append to ") + LIVE_SYMBOL + ": status " + std::to_string(statusOf(res)) + " " +
+                     excerpt(res.body));
+                return;
+            }
+            ++rows;
+
+            httplib::Response predicted;
+            server.handlePredict(predictRequest(LIVE_SYMBOL, "SMA", {{"window_size", 20}}, "", false), predicted);
+            if (statusOf(predicted) != 200) {
+                fail("live predict: status " + std::to_string(statusOf(predicted)) + " " + excerpt(predicted.body));
+                continue;
+            }
+            // Other threads never append, so every bar so far is included
+            size_t count = json::parse(predicted.body)["predictions"].size();
+            if (count != rows - 20 + 1) {
+                fail("live predict: " + std::to_string(count) + " predictions after " + std::to_string(rows) +
+                     " rows");
+            }
+        }
+    }
+
+    // Appending to a snapshot-only symbol must keep the snapshot's bars, both
+    // in the file and in the live SMA series computed before the append
+    void checkSnapshotAppend(StockServer& server, const fs::path& dataDir) {
+        fs::path csv = dataDir / (std::string(SNAPSHOT_SYMBOL) + ".csv");
+        writeCsv(csv, ROWS, 7);
+        Snapshot::write(FileHandler(dataDir.string()).readStockData(SNAPSHOT_SYMBOL),
+                        (dataDir / (std::string(SNAPSHOT_SYMBOL) + Snapshot::FILE_EXTENSION)).string());
+        fs::remove(csv);
+
+        auto predict = [&](const std::string& stage) {
+            httplib::Response res;
+            server.handlePredict(predictRequest(SNAPSHOT_SYMBOL, "SMA", {{"window_size", 20}}, "", false), res);
+            if (statusOf(res) != 200) {
+                throw std::runtime_error("snapshot predict " + stage + ": status " +
+                                         std::to_string(statusOf(res)) + " " + excerpt(res.body));
+            }
+            return json::parse(res.body);
+        };
+
+        json before = predict("before append");
+        httplib::Response appended = appendBar(server, SNAPSHOT_SYMBOL, ROWS, 123.0);
+        if (statusOf(appended) != 200) {
+            throw std::runtime_error("snapshot append: status " + std::to_string(statusOf(appended)) + " " +
+                                     excerpt(appended.body));
+        }
+        json after = predict("after append");
+
+        size_t count = after["predictions"].size();
+        if (count != ROWS + 1 - 20 + 1) {
+            fail("snapshot append: " + std::to_string(count) + " predictions, expected " +
+                 std::to_string(ROWS + 1 - 20 + 1));
+        }
+        // Every date known before the append is unchanged; only the last
+        // prediction's bar (past the end until now) can differ
+        const json& oldDates = before["dates"];
+        const json& newDates = after["dates"];
+        for (size_t i = 0; i + 1 < oldDates.size(); ++i) {
+            if (i >= newDates.size() || newDates[i] != oldDates[i]) {
+                fail("snapshot append: date " + std::to_string(i) + " changed after the append");
+                break;
+            }
+        }
+
+        size_t stored = FileHandler(dataDir.string()).readStockData(SNAPSHOT_SYMBOL).size();
+        if (stored != ROWS + 1) {
+            fail("snapshot append: " + std::to_string(stored) + " bars stored, expected " +
+                 std::to_string(ROWS + 1));
+        }
+    }
+
+    void statsLoop(StockServer& server, const std::atomic<bool>& stop) {
+        while (!stop.load()) {
+            httplib::Response res;
+            server.handleCacheStats(httplib::Request(), res);
+            if (statusOf(res) != 200 || !json::parse(res.body).is_object()) {
+                fail("cache stats: " + excerpt(res.body));
+            }
+            server.getPredictor().getCacheStats();
+            server.getPredictor().getResultCacheStats();
+            std::this_thread::yield();
+        }
+    }
+}
+
+int main() {
+    std::random_device entropy;
+    fs::path dataDir = fs::temp_directory_path() / ("predict_stress_" + std::to_string(entropy()));
+    int status = 0;
+    try {
+        fs::create_directories(dataDir);
+        for (size_t s = 0; s < SYMBOLS; ++s) {
+            writeCsv(dataDir / ("S" + std::to_string(s) + ".csv"), ROWS, 11 + s);
+        }
+        writeCsv(dataDir / (std::string(LIVE_SYMBOL) + ".csv"), ROWS, 99);
+
+        StockServer server(dataDir.string(), CACHE_BUDGET, 0, 4);
+        checkSnapshotAppend(server, dataDir);
+
+        std::vector<Case> cases = makeCases();
+        for (auto& c : cases) {
+            httplib::Response res;
+            server.handlePredict(predictRequest(c.symbol, c.algorithm, c.parameters, c.accept, false), res);
+            if (statusOf(res) != 200) {
+                throw std::runtime_error(describe(c) + ": status " + std::to_string(statusOf(res)) + " " +
+                                         excerpt(res.body));
+            }
+            c.body = res.body;
+            c.etag = res.get_header_value("ETag");
+        }
+        std::cout << cases.size() << " reference responses, " << THREADS << " threads x " << REQUESTS_PER_THREAD
+                  << " requests" << std::endl;
+
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> background;
+        background.emplace_back(registerLoop, std::ref(server), std::cref(stop));
+        background.emplace_back(appendLoop, std::ref(server), std::cref(stop));
+        background.emplace_back(statsLoop, std::ref(server), std::cref(stop));
+
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < THREADS; ++t) {
+            workers.emplace_back(predictLoop, std::ref(server), std::cref(cases), 1000 + t);
+        }
+        for (auto& worker : workers) worker.join();
+        stop.store(true);
+        for (auto& thread : background) thread.join();
+
+        CacheStats series = server.getPredictor().getCacheStats();
+        CacheStats results = server.getPredictor().getResultCacheStats();
+        std::cout << "series cache: " << series.hits << " hits, " << series.misses << " misses, " << series.evictions
+                  << " evictions; result cache: " << results.hits << " hits, " << results.misses << " misses"
+                  << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        status = 1;
+    }
+
+    std::error_code ec;
+    fs::remove_all(dataDir, ec);
+
+    if (status == 0 && failures.load() > 0) {
+        std::cerr << failures.load() << " check(s) failed\n";
+        status = 1;
+    }
+    if (status == 0) std::cout << "all concurrent predictions matched" << std::endl;
+    return status;
+}
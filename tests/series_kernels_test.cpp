@@ -0,0 +1,144 @@
+// Checks SeriesKernels::rollingMean (the dispatched path, AVX2 where the CPU
+// has it), rollingMeanScalar and MovingAverageAlgorithm::predict against a
+// naive std::accumulate mean of every window.
+//
+// Lengths are chosen around the kernels' boundaries: shorter than the
+// window, not multiples of 4, of the window or of RESUM_INTERVAL, and long
+// enough for the AVX2 path to split into four stretches and re-seed.
+
+#include "../include/DateTime.h"
+#include "../include/PredictionAlgorithm.h"
+#include "../include/SeriesKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr double RELATIVE_TOLERANCE = 1e-9;
+    // Written where the kernels must not write
+    constexpr double UNTOUCHED = -12345.0;
+
+    size_t failures = 0;
+
+    std::vector<double> randomWalk(size_t count, uint64_t seed) {
+        std::mt19937_64 random(seed);
+        std::normal_distribution<double> step(0.0, 0.8);
+        std::vector<double> values(count);
+        double value = 100.0;
+        for (auto& v : values) {
+            value = std::max(1.0, value + step(random));
+            v = value;
+        }
+        return values;
+    }
+
+    std::vector<double> naiveMeans(const std::vector<double>& values, size_t count, size_t window) {
+        std::vector<double> means;
+        for (size_t i = 0; i + window <= count; ++i) {
+            means.push_back(std::accumulate(values.begin() + i, values.begin() + i + window, 0.0) /
+                            static_cast<double>(window));
+        }
+        return means;
+    }
+
+    // Compares out[0 .. expected.size()) and checks the slot after it was left alone
+    void compare(const std::string& what, const std::vector<double>& expected, const std::vector<double>& out) {
+        for (size_t i = 0; i < expected.size(); ++i) {
+            double scale = std::max(1.0, std::fabs(expected[i]));
+            if (!(std::fabs(out[i] - expected[i]) <= RELATIVE_TOLERANCE * scale)) {
+                std::cerr << "FAIL " << what << ": out[" << i << "] = " << out[i] << ", expected " << expected[i]
+                          << "\n";
+                ++failures;
+                return;
+            }
+        }
+        if (out[expected.size()] != UNTOUCHED) {
+            std::cerr << "FAIL " << what << ": wrote past the last output\n";
+            ++failures;
+        }
+    }
+
+    void checkKernels(const std::vector<double>& values, size_t count, size_t window) {
+        std::vector<double> expected = naiveMeans(values, count, window);
+        std::string label = "window=" + std::to_string(window) + " n=" + std::to_string(count);
+
+        std::vector<double> out(expected.size() + 1, UNTOUCHED);
+        SeriesKernels::rollingMean(values.data(), count, window, out.data());
+        compare("rollingMean " + label, expected, out);
+
+        std::fill(out.begin(), out.end(), UNTOUCHED);
+        SeriesKernels::rollingMeanScalar(values.data(), count, window, out.data());
+        compare("rollingMeanScalar " + label, expected, out);
+    }
+
+    void checkMovingAverage(const std::vector<double>& values, size_t count, int window) {
+        PriceSeries series("TEST");
+        const int64_t start = DateTime::daysFromCivil(2000, 1, 3) * DateTime::SECONDS_PER_DAY;
+        for (size_t i = 0; i < count; ++i) {
+            int64_t timestamp = start + static_cast<int64_t>(i) * 60;
+            series.append(DateTime::format(timestamp, true), timestamp, values[i], values[i], values[i], values[i], 1.0);
+        }
+        std::string label = "MovingAverageAlgorithm window=" + std::to_string(window) + " n=" + std::to_string(count);
+        if (count < static_cast<size_t>(window)) {
+            // Too short for a single prediction: reported, not silently empty
+            try {
+                MovingAverageAlgorithm(window).predict(series);
+                std::cerr << "FAIL " << label << ": expected an insufficient-data error\n";
+                ++failures;
+            } catch (const std::runtime_error&) {
+            }
+            return;
+        }
+        std::vector<double> expected = naiveMeans(values, count, static_cast<size_t>(window));
+        std::vector<double> out = MovingAverageAlgorithm(window).predict(series);
+        if (out.size() != expected.size()) {
+            std::cerr << "FAIL " << label << ": " << out.size() << " predictions, expected " << expected.size() << "\n";
+            ++failures;
+            return;
+        }
+        out.push_back(UNTOUCHED);
+        compare(label, expected, out);
+    }
+}
+
+int main() {
+    const size_t resum = SeriesKernels::RESUM_INTERVAL;
+    const size_t longest = 4 * resum * 2 + 200 + 1003;
+    std::vector<double> values = randomWalk(longest, 7);
+
+    std::cout << "instruction set: " << SeriesKernels::activeInstructionSet() << "\n";
+
+    for (size_t window = 1; window <= 200; ++window) {
+        std::vector<size_t> lengths = {1, 2, 3, 5, 7, 13, 63, 101, 1021, 4099};
+        if (window > 1) lengths.push_back(window - 1);
+        lengths.insert(lengths.end(), {window, window + 1, window + 3, window + 67, window + resum + 5});
+        for (size_t count : lengths) {
+            checkKernels(values, count, window);
+        }
+    }
+
+    // Long enough for four AVX2 stretches, each re-seeded more than once
+    for (size_t window : {1, 2, 3, 5, 7, 20, 50, 97, 199, 200}) {
+        for (size_t count : {4 * resum + window + 37, 4 * resum * 2 + window + 1003, longest - 1}) {
+            checkKernels(values, count, window);
+        }
+    }
+
+    for (int window : {2, 5, 10, 20, 37, 50, 100, 200}) {
+        for (size_t count : {static_cast<size_t>(window) - 1, static_cast<size_t>(window) + 11, 4 * resum + 333}) {
+            checkMovingAverage(values, count, window);
+        }
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "all rolling-mean checks passed\n";
+    return 0;
+}
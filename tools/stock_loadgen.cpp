@@ -0,0 +1,430 @@
+// HTTP load generator for a running stock_server.
+//
+//   stock_loadgen [--host HOST] [--port PORT] [--concurrency N] [--duration SECONDS]
+//                 [--warmup SECONDS] [--rate RPS] [--mix predict=70,stocks=25,analyze=5]
+//                 [--symbols A,B,...] [--data-dir DIR] [--generate DIR --synthetic N --rows N]
+//                 [--algorithms SMA,EMA] [--limit N] [--cold] [--persist] [--seed N] [--json FILE]
+//
+// Without --rate the run is closed-loop: every connection sends its next
+// request as soon as the previous one completes. With --rate the run is
+// open-loop: requests are scheduled at a fixed total rate and latency is
+// measured from the scheduled start, so a stalled server shows up in the
+// tail instead of silently lowering the offered load.
+#include "../include/DateTime.h"
+#include "../include/Metrics.h"
+#include "httplib.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    enum Endpoint { PREDICT, STOCKS, ANALYZE, ENDPOINT_COUNT };
+    const char* const ENDPOINT_NAMES[ENDPOINT_COUNT] = {"predict", "stocks", "analyze"};
+
+    struct Options {
+        std::string host = "127.0.0.1";
+        int port = 3000;
+        size_t concurrency = 8;
+        double duration = 10.0;
+        double warmup = 2.0;
+        double rate = 0.0;  // 0: closed-loop
+        unsigned weights[ENDPOINT_COUNT] = {70, 25, 5};
+        std::vector<std::string> symbols;
+        std::string dataDir = "data";
+        std::string generateDir;
+        size_t syntheticSymbols = 0;
+        size_t syntheticRows = 10000;
+        std::vector<std::string> algorithms = {"SMA", "EMA"};
+        size_t limit = 0;  // 0: whole series on /api/stocks
+        bool cold = false;
+        bool persist = false;
+        uint64_t seed = 1;
+        std::string jsonPath;
+    };
+
+    struct EndpointStats {
+        LatencyHistogram latency;
+        uint64_t requests = 0;
+        uint64_t errors = 0;  // transport failures and non-2xx/304 statuses
+        uint64_t bytes = 0;
+        uint64_t maxNs = 0;
+
+        void merge(const EndpointStats& other) {
+            latency.merge(other.latency);
+            requests += other.requests;
+            errors += other.errors;
+            bytes += other.bytes;
+            maxNs = std::max(maxNs, other.maxNs);
+        }
+    };
+
+    void printUsage() {
+        std::cerr << "Usage: stock_loadgen [--host HOST] [--port PORT] [--concurrency N] [--duration SECONDS]\n"
+                  << "                     [--warmup SECONDS] [--rate RPS] [--mix predict=70,stocks=25,analyze=5]\n"
+                  << "                     [--symbols A,B,...] [--data-dir DIR]\n"
+                  << "                     [--generate DIR --synthetic N --rows N]\n"
+                  << "                     [--algorithms SMA,EMA] [--limit N] [--cold] [--persist]\n"
+                  << "                     [--seed N] [--json FILE]\n";
+    }
+
+    std::vector<std::string> splitList(const std::string& text) {
+        std::vector<std::string> items;
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (!item.empty()) items.push_back(item);
+        }
+        return items;
+    }
+
+    void parseMix(const std::string& text, unsigned (&weights)[ENDPOINT_COUNT]) {
+        std::fill(std::begin(weights), std::end(weights), 0u);
+        for (const auto& item : splitList(text)) {
+            size_t equals = item.find('=');
+            std::string name = item.substr(0, equals);
+            auto endpoint = std::find(std::begin(ENDPOINT_NAMES), std::end(ENDPOINT_NAMES), name);
+            if (equals == std::string::npos || endpoint == std::end(ENDPOINT_NAMES)) {
+                throw std::invalid_argument("Invalid --mix entry: " + item);
+            }
+            weights[endpoint - std::begin(ENDPOINT_NAMES)] = static_cast<unsigned>(std::stoul(item.substr(equals + 1)));
+        }
+        if (std::all_of(std::begin(weights), std::end(weights), [](unsigned w) { return w == 0; })) {
+            throw std::invalid_argument("--mix needs at least one non-zero weight");
+        }
+    }
+
+    Options parseOptions(int argc, char* argv[]) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto next = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--host") options.host = next();
+            else if (arg == "--port") options.port = std::stoi(next());
+            else if (arg == "--concurrency") options.concurrency = std::stoul(next());
+            else if (arg == "--duration") options.duration = std::stod(next());
+            else if (arg == "--warmup") options.warmup = std::stod(next());
+            else if (arg == "--rate") options.rate = std::stod(next());
+            else if (arg == "--mix") parseMix(next(), options.weights);
+            else if (arg == "--symbols") options.symbols = splitList(next());
+            else if (arg == "--data-dir") options.dataDir = next();
+            else if (arg == "--generate") options.generateDir = next();
+            else if (arg == "--synthetic") options.syntheticSymbols = std::stoul(next());
+            else if (arg == "--rows") options.syntheticRows = std::stoul(next());
+            else if (arg == "--algorithms") options.algorithms = splitList(next());
+            else if (arg == "--limit") options.limit = std::stoul(next());
+            else if (arg == "--cold") options.cold = true;
+            else if (arg == "--persist") options.persist = true;
+            else if (arg == "--seed") options.seed = std::stoull(next());
+            else if (arg == "--json") options.jsonPath = next();
+            else throw std::invalid_argument("Unknown option: " + arg);
+        }
+        if (options.concurrency == 0) throw std::invalid_argument("--concurrency must be positive");
+        if (options.duration <= 0.0) throw std::invalid_argument("--duration must be positive");
+        if (options.warmup < 0.0 || options.rate < 0.0) throw std::invalid_argument("--warmup and --rate must not be negative");
+        if (options.algorithms.empty()) throw std::invalid_argument("--algorithms must name at least one algorithm");
+        if (!options.generateDir.empty() && options.syntheticSymbols == 0) options.syntheticSymbols = 8;
+        return options;
+    }
+
+    // Random-walk daily bars in the format of the files in data/
+    std::string syntheticCsv(size_t rows, uint64_t seed) {
+        std::mt19937_64 random(seed);
+        std::normal_distribution<double> step(0.0, 1.0);
+        std::uniform_real_distribution<double> spread(0.0, 1.5);
+        std::uniform_int_distribution<int> volume(1000000, 90000000);
+
+        std::string csv = "Date,Open,High,Low,Close,Volume\n";
+        csv.reserve(csv.size() + rows * 64);
+        const int64_t firstDay = DateTime::daysFromCivil(1990, 1, 1);
+        double close = 100.0;
+        char line[128];
+        for (size_t i = 0; i < rows; ++i) {
+            double open = close;
+            close = std::max(1.0, open + step(random));
+            double high = std::max(open, close) + spread(random);
+            double low = std::max(0.5, std::min(open, close) - spread(random));
+            int length = std::snprintf(line, sizeof(line), "%s,%.2f,%.2f,%.2f,%.2f,%d\n",
+                                       DateTime::format((firstDay + static_cast<int64_t>(i)) * DateTime::SECONDS_PER_DAY).c_str(),
+                                       open, high, low, close, volume(random));
+            csv.append(line, static_cast<size_t>(length));
+        }
+        return csv;
+    }
+
+    void writeFile(const std::filesystem::path& path, const std::string& content) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(content.data(), static_cast<std::streamsize>(content.size()));
+        if (!out) throw std::runtime_error("Could not write file: " + path.string());
+    }
+
+    std::string readFile(const std::filesystem::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("Could not open file: " + path.string());
+        std::ostringstream content;
+        content << in.rdbuf();
+        return content.str();
+    }
+
+    // Symbols named by --symbols, generated by --generate, or every CSV in --data-dir
+    std::vector<std::string> resolveSymbols(const Options& options, std::string& upload) {
+        namespace fs = std::filesystem;
+        std::vector<std::string> symbols = options.symbols;
+
+        if (!options.generateDir.empty()) {
+            fs::create_directories(options.generateDir);
+            for (size_t i = 0; i < options.syntheticSymbols; ++i) {
+                std::string symbol = "SYN" + std::to_string(i);
+                writeFile(fs::path(options.generateDir) / (symbol + ".csv"),
+                          syntheticCsv(options.syntheticRows, options.seed + i));
+                if (options.symbols.empty()) symbols.push_back(symbol);
+            }
+            std::cerr << "Generated " << options.syntheticSymbols << " symbols of " << options.syntheticRows
+                      << " rows in " << options.generateDir << "\n";
+        }
+
+        if (symbols.empty() && fs::is_directory(options.dataDir)) {
+            for (const auto& entry : fs::directory_iterator(options.dataDir)) {
+                std::string name = entry.path().filename().string();
+                if (entry.path().extension() == ".csv" && name.find("_predictions") == std::string::npos) {
+                    symbols.push_back(entry.path().stem().string());
+                }
+            }
+            std::sort(symbols.begin(), symbols.end());
+        }
+        if (symbols.empty()) {
+            throw std::runtime_error("No symbols: pass --symbols, --generate, or a --data-dir with CSV files");
+        }
+
+        // /api/analyze uploads one of the symbols' files when it is local,
+        // otherwise a synthetic file of --rows rows
+        std::string dir = options.generateDir.empty() ? options.dataDir : options.generateDir;
+        fs::path local = fs::path(dir) / (symbols.front() + ".csv");
+        upload = fs::exists(local) ? readFile(local) : syntheticCsv(options.syntheticRows, options.seed);
+        return symbols;
+    }
+
+    struct Worker {
+        std::array<EndpointStats, ENDPOINT_COUNT> stats;
+    };
+
+    class LoadGenerator {
+    private:
+        const Options& options;
+        std::vector<std::string> symbols;
+        std::string upload;
+        std::discrete_distribution<int> mix;
+
+        Clock::time_point start;
+        Clock::time_point measureFrom;
+        Clock::time_point stopAt;
+        std::atomic<uint64_t> nextSlot{0};  // open-loop schedule position
+
+        std::string predictBody(std::mt19937_64& random) const {
+            const std::string& symbol = symbols[random() % symbols.size()];
+            const std::string& algorithm = options.algorithms[random() % options.algorithms.size()];
+            json body = {{"symbol", symbol}, {"algorithm", algorithm}, {"persist", options.persist}};
+            if (options.cold) {
+                // Parameters the result cache has probably not seen yet
+                if (algorithm == "SMA") body["parameters"] = {{"window_size", 2 + random() % 199}};
+                else if (algorithm == "EMA") body["parameters"] = {{"alpha", 0.001 + (random() % 999) / 1000.0}};
+            }
+            return body.dump();
+        }
+
+        void send(httplib::Client& client, int endpoint, std::mt19937_64& random,
+                  Clock::time_point scheduled, Worker& worker) {
+            auto result = [&]() {
+                if (endpoint == PREDICT) {
+                    return client.Post("/api/predict", predictBody(random), "application/json");
+                }
+                if (endpoint == STOCKS) {
+                    std::string path = "/api/stocks/" + symbols[random() % symbols.size()];
+                    if (options.limit > 0) path += "?limit=" + std::to_string(options.limit);
+                    return client.Get(path.c_str());
+                }
+                httplib::MultipartFormDataItems items = {{"csv_file", upload, "upload.csv", "text/csv"}};
+                return client.Post("/api/analyze", items);
+            }();
+            auto finished = Clock::now();
+            if (scheduled < measureFrom) return;
+
+            EndpointStats& stats = worker.stats[endpoint];
+            uint64_t elapsed = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(finished - scheduled).count());
+            stats.latency.record(elapsed);
+            stats.maxNs = std::max(stats.maxNs, elapsed);
+            ++stats.requests;
+            if (!result) {
+                ++stats.errors;
+                return;
+            }
+            stats.bytes += result->body.size();
+            if (result->status >= 400) ++stats.errors;
+        }
+
+        void run(size_t index, Worker& worker) {
+            std::mt19937_64 random(options.seed * 7919 + index);
+            std::discrete_distribution<int> pick = mix;
+            httplib::Client client(options.host, options.port);
+            client.set_keep_alive(true);
+            client.set_connection_timeout(5);
+            client.set_read_timeout(60);
+
+            while (true) {
+                Clock::time_point scheduled;
+                if (options.rate > 0.0) {
+                    // Claim the next slot of the fixed schedule and wait for it;
+                    // a late slot is sent at once and its wait counts as latency
+                    uint64_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed);
+                    scheduled = start + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>(static_cast<double>(slot) / options.rate));
+                    if (scheduled >= stopAt) return;
+                    std::this_thread::sleep_until(scheduled);
+                } else {
+                    scheduled = Clock::now();
+                    if (scheduled >= stopAt) return;
+                }
+                send(client, pick(random), random, scheduled, worker);
+            }
+        }
+
+    public:
+        LoadGenerator(const Options& opts, std::vector<std::string> symbolList, std::string uploadCsv)
+            : options(opts), symbols(std::move(symbolList)), upload(std::move(uploadCsv)),
+              mix(std::begin(opts.weights), std::end(opts.weights)) {}
+
+        // Runs warm-up plus the measured period; returns per-endpoint totals
+        std::array<EndpointStats, ENDPOINT_COUNT> execute() {
+            std::vector<Worker> workers(options.concurrency);
+            std::vector<std::thread> threads;
+            start = Clock::now();
+            measureFrom = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.warmup));
+            stopAt = measureFrom + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration));
+
+            for (size_t i = 0; i < options.concurrency; ++i) {
+                threads.emplace_back([this, i, &workers] { run(i, workers[i]); });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            std::array<EndpointStats, ENDPOINT_COUNT> totals;
+            for (const auto& worker : workers) {
+                for (int e = 0; e < ENDPOINT_COUNT; ++e) {
+                    totals[e].merge(worker.stats[e]);
+                }
+            }
+            return totals;
+        }
+    };
+
+    json statsToJson(const EndpointStats& stats, double seconds) {
+        // Bucket upper bounds can overshoot the largest value actually seen
+        auto ms = [&stats](uint64_t ns) { return static_cast<double>(std::min(ns, stats.maxNs)) / 1e6; };
+        return {
+            {"requests", stats.requests},
+            {"errors", stats.errors},
+            {"throughput_rps", static_cast<double>(stats.requests) / seconds},
+            {"bytes_per_second", static_cast<double>(stats.bytes) / seconds},
+            {"latency_ms", {
+                {"mean", stats.requests ? static_cast<double>(stats.latency.getSum()) / 1e6 / static_cast<double>(stats.requests) : 0.0},
+                {"p50", ms(stats.latency.quantile(0.50))},
+                {"p90", ms(stats.latency.quantile(0.90))},
+                {"p99", ms(stats.latency.quantile(0.99))},
+                {"p999", ms(stats.latency.quantile(0.999))},
+                {"max", ms(stats.maxNs)}
+            }}
+        };
+    }
+
+    void printRow(const std::string& name, const json& row) {
+        const json& latency = row["latency_ms"];
+        std::printf("%-8s %9llu %7llu %10.1f %9.3f %9.3f %9.3f %9.3f %9.3f\n", name.c_str(),
+                    row["requests"].get<unsigned long long>(), row["errors"].get<unsigned long long>(),
+                    row["throughput_rps"].get<double>(), latency["p50"].get<double>(), latency["p90"].get<double>(),
+                    latency["p99"].get<double>(), latency["p999"].get<double>(), latency["max"].get<double>());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        printUsage();
+        return 2;
+    }
+
+    try {
+        std::string upload;
+        auto symbols = resolveSymbols(options, upload);
+        if (options.rate > 0.0) std::cerr << "Open-loop at " << options.rate << " req/s";
+        else std::cerr << "Closed-loop";
+        std::cerr << ", " << options.concurrency << " connections, " << symbols.size() << " symbols, "
+                  << options.warmup << " s warm-up + " << options.duration << " s against "
+                  << options.host << ":" << options.port << "\n";
+
+        LoadGenerator generator(options, symbols, upload);
+        auto totals = generator.execute();
+
+        EndpointStats overall;
+        json endpoints = json::object();
+        for (int e = 0; e < ENDPOINT_COUNT; ++e) {
+            overall.merge(totals[e]);
+            if (options.weights[e] > 0) endpoints[ENDPOINT_NAMES[e]] = statsToJson(totals[e], options.duration);
+        }
+        json report = {
+            {"config", {
+                {"host", options.host},
+                {"port", options.port},
+                {"mode", options.rate > 0.0 ? "open" : "closed"},
+                {"rate", options.rate},
+                {"concurrency", options.concurrency},
+                {"duration_s", options.duration},
+                {"warmup_s", options.warmup},
+                {"symbols", symbols.size()},
+                {"cold", options.cold},
+                {"mix", {{"predict", options.weights[PREDICT]}, {"stocks", options.weights[STOCKS]},
+                         {"analyze", options.weights[ANALYZE]}}}
+            }},
+            {"endpoints", endpoints},
+            {"total", statsToJson(overall, options.duration)}
+        };
+
+        std::printf("%-8s %9s %7s %10s %9s %9s %9s %9s %9s\n", "endpoint", "requests", "errors", "req/s",
+                    "p50 ms", "p90 ms", "p99 ms", "p99.9 ms", "max ms");
+        for (auto it = endpoints.begin(); it != endpoints.end(); ++it) {
+            printRow(it.key(), it.value());
+        }
+        printRow("total", report["total"]);
+        std::printf("Percentiles are bucket upper bounds (within 12.5%%).\n");
+
+        if (!options.jsonPath.empty()) {
+            std::ofstream out(options.jsonPath);
+            out << report.dump(2) << "\n";
+            if (!out) throw std::runtime_error("Could not write file: " + options.jsonPath);
+        }
+        return overall.errors > 0 ? 1 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}